@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <memory>
+#include <string>
+
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+#include "PerfReport.hpp"
+
+namespace
+{
+    MatrixF random_layer(unsigned int size)
+    {
+        MatrixF result(size, 1);
+        for (unsigned int i = 0; i < size; i++)
+        {
+            result(i, 0) = static_cast<float>(rand()) / RAND_MAX * 8 - 4;
+        }
+        return result;
+    }
+
+    void activator_benchmarks(const std::string& name, IActivatorFunc& activator)
+    {
+        const auto layer = random_layer(256);
+        auto values = layer;
+
+        BENCHMARK(perf::items(name + "::func(Matrix) 256x1", 1))
+        {
+            return activator.func(layer);
+        };
+
+        BENCHMARK(perf::items(name + "::derivative_func(Matrix) 256x1", 1))
+        {
+            return activator.derivative_func(layer);
+        };
+
+        BENCHMARK(perf::items(name + "::func_inplace 256", 1))
+        {
+            values = layer;
+            activator.func_inplace(values.data(), 256);
+            return values.data()[0];
+        };
+
+        BENCHMARK(perf::items(name + "::derivative_inplace 256", 1))
+        {
+            values = layer;
+            activator.derivative_inplace(values.data(), 256);
+            return values.data()[0];
+        };
+
+        auto outputs = layer;
+        activator.func_inplace(outputs.data(), 256);
+        BENCHMARK(perf::items(name + "::backward_inplace 256", 1))
+        {
+            values = layer;
+            activator.backward_inplace(outputs.data(), values.data(), 256);
+            return values.data()[0];
+        };
+    }
+}
+
+TEST_CASE("Activator funcs on a hidden layer", "[activator]")
+{
+    SigmoidFunc sigmoid;
+    activator_benchmarks("SigmoidFunc", sigmoid);
+
+    ModReluFunc mod_relu;
+    activator_benchmarks("ModReluFunc", mod_relu);
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+
+#include "Matrix.hpp"
+#include "PerfReport.hpp"
+
+namespace
+{
+    template<typename T>
+    BasicMatrix<T> random_matrix(unsigned int rows, unsigned int cols)
+    {
+        BasicMatrix<T> result(rows, cols);
+        for (unsigned int i = 0; i < rows; i++)
+        {
+            for (unsigned int j = 0; j < cols; j++)
+            {
+                result(i, j) = static_cast<T>(rand()) / RAND_MAX - static_cast<T>(0.5);
+            }
+        }
+        return result;
+    }
+
+    template<typename T>
+    std::string type_name()
+    {
+        return sizeof(T) == sizeof(float) ? "float" : "double";
+    }
+}
+
+// Shapes of the deployed 784-256-10 network.
+TEMPLATE_TEST_CASE("Matrix products at the network shapes", "[matrix]", float, double)
+{
+    const auto hidden_weights = random_matrix<TestType>(256, 784);
+    const auto output_weights = random_matrix<TestType>(10, 256);
+    const auto input = random_matrix<TestType>(784, 1);
+    const auto hidden = random_matrix<TestType>(256, 1);
+    BasicMatrix<TestType> result(1, 1);
+
+    BENCHMARK(perf::items("Matrix<" + type_name<TestType>() + ">::operator* 256x784 * 784x1", 1))
+    {
+        return hidden_weights * input;
+    };
+
+    BENCHMARK(perf::items("Matrix<" + type_name<TestType>() + ">::operator* 10x256 * 256x1", 1))
+    {
+        return output_weights * hidden;
+    };
+
+    BENCHMARK(perf::items("Matrix<" + type_name<TestType>() + ">::multiply 256x784 * 784x1 into a reused result", 1))
+    {
+        BasicMatrix<TestType>::multiply(hidden_weights, input, result);
+        return result.data()[0];
+    };
+
+    const auto batch = random_matrix<TestType>(784, 64);
+    BENCHMARK(perf::items("Matrix<" + type_name<TestType>() + ">::operator* 256x784 * 784x64", 64))
+    {
+        return hidden_weights * batch;
+    };
+}
+
+TEMPLATE_TEST_CASE("Matrix transpose", "[matrix]", float, double)
+{
+    const auto weights = random_matrix<TestType>(256, 784);
+    BasicMatrix<TestType> result(1, 1);
+
+    BENCHMARK("Matrix<" + type_name<TestType>() + ">::transponate 256x784")
+    {
+        return BasicMatrix<TestType>::transponate(weights);
+    };
+
+    BENCHMARK("Matrix<" + type_name<TestType>() + ">::transponate 256x784 into a reused result")
+    {
+        BasicMatrix<TestType>::transponate(weights, result);
+        return result.data()[0];
+    };
+}
+
+TEMPLATE_TEST_CASE("Matrix elementwise expressions", "[matrix]", float, double)
+{
+    const auto a = random_matrix<TestType>(256, 784);
+    const auto b = random_matrix<TestType>(256, 784);
+    BasicMatrix<TestType> result(256, 784);
+
+    BENCHMARK("Matrix<" + type_name<TestType>() + "> a + b * 0.5 256x784")
+    {
+        result = a + b * static_cast<TestType>(0.5);
+        return result.data()[0];
+    };
+}
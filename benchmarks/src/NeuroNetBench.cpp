@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "NeuroNet.hpp"
+#include "PerfReport.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    std::vector<float> random_input(unsigned int size)
+    {
+        std::vector<float> input(size);
+        for (auto& value : input)
+        {
+            value = static_cast<float>(rand()) / RAND_MAX;
+        }
+        return input;
+    }
+
+    // read_weights and save_weights report to std::cout, keep that out of the results.
+    struct SilenceCout
+    {
+        std::ostringstream sink;
+        std::streambuf* saved = std::cout.rdbuf(sink.rdbuf());
+        ~SilenceCout() { std::cout.rdbuf(saved); }
+    };
+}
+
+TEST_CASE("NeuroNet hot paths on the 784-256-10 network", "[neuronet]")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 256, 10}, activator);
+    const auto input = random_input(784);
+
+    BENCHMARK(perf::items("NeuroNet::analyze", 1))
+    {
+        return net.analyze(input);
+    };
+
+    net.analyze(input);
+    BENCHMARK(perf::items("NeuroNet::back_propagate", 1))
+    {
+        net.back_propagate(3, 1e-4);
+        return net.weights()[0].data()[0];
+    };
+
+    BENCHMARK(perf::items("NeuroNet::analyze + back_propagate", 1))
+    {
+        net.analyze(input);
+        net.back_propagate(3, 1e-4);
+        return net.weights()[0].data()[0];
+    };
+}
+
+TEST_CASE("NeuroNet offline scoring on the 784-256-10 network", "[neuronet][batch]")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 256, 10}, activator);
+
+    std::vector<std::vector<float>> inputs;
+    for (int sample = 0; sample < 1024; sample++)
+    {
+        inputs.push_back(random_input(784));
+    }
+
+    BENCHMARK(perf::items("NeuroNet::analyze x1024", 1024))
+    {
+        int sum = 0;
+        for (const auto& input : inputs)
+        {
+            sum += net.analyze(input);
+        }
+        return sum;
+    };
+
+    // samples_per_sec grows with the batch until the GEMMs are compute bound.
+    for (const unsigned int batch : {1u, 8u, 64u, 256u, 1024u})
+    {
+        const std::vector<std::vector<float>> block(inputs.begin(), inputs.begin() + batch);
+        BENCHMARK(perf::items("NeuroNet::analyze_batch " + std::to_string(batch), batch))
+        {
+            return net.analyze_batch(block).back();
+        };
+    }
+}
+
+TEST_CASE("NeuroNet weights files", "[neuronet][io]")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 256, 10}, activator);
+    const std::string filename = "neuronet_bench_weights.txt";
+
+    SilenceCout silence;
+    net.save_weights(filename);
+
+    BENCHMARK("NeuroNet::save_weights 784-256-10")
+    {
+        net.save_weights(filename);
+    };
+
+    BENCHMARK("NeuroNet::read_weights 784-256-10")
+    {
+        net.read_weights(filename);
+        return net.weights()[0].data()[0];
+    };
+
+    std::remove(filename.c_str());
+}
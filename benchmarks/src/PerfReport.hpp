@@ -0,0 +1,131 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One finished benchmark, times in nanoseconds per call of the benchmarked code.
+// items_per_call is how many samples (or matrix products) one call processes, as
+// registered with perf::items(). It is 0 for benchmarks that process none, e.g.
+// reading a weights file, and those get no samples_per_sec.
+struct PerfResult
+{
+    std::string name;
+    int samples = 0;
+    int iterations = 0;
+    double mean_ns = 0;
+    double low_mean_ns = 0;
+    double high_mean_ns = 0;
+    double std_dev_ns = 0;
+    unsigned int items_per_call = 0;
+
+    bool has_samples_per_sec() const
+    {
+        return items_per_call > 0 and mean_ns > 0;
+    }
+
+    double samples_per_sec() const
+    {
+        return has_samples_per_sec() ? items_per_call * 1e9 / mean_ns : 0;
+    }
+};
+
+namespace perf
+{
+    inline std::map<std::string, unsigned int>& registered_items()
+    {
+        static std::map<std::string, unsigned int> items;
+        return items;
+    }
+
+    // Returns name and records that one call of its benchmark processes count items:
+    //     BENCHMARK(perf::items("NeuroNet::analyze_batch 64", 64))
+    inline std::string items(const std::string& name, unsigned int count)
+    {
+        registered_items()[name] = count;
+        return name;
+    }
+
+    // Items per call registered for name, 0 when none were.
+    inline unsigned int items_of(const std::string& name)
+    {
+        const auto found = registered_items().find(name);
+        return found != registered_items().end() ? found->second : 0;
+    }
+
+    // JSON string: quotes and backslashes are escaped with a backslash.
+    inline std::string json_quoted(const std::string& text)
+    {
+        std::string result(1, '"');
+        for (char c : text)
+        {
+            if (c == '"' or c == '\\')
+                result += '\\';
+            result += c;
+        }
+        result += '"';
+        return result;
+    }
+
+    // CSV field (RFC 4180): quotes are doubled, the field is quoted.
+    inline std::string csv_quoted(const std::string& text)
+    {
+        std::string result(1, '"');
+        for (char c : text)
+        {
+            if (c == '"')
+                result += '"';
+            result += c;
+        }
+        result += '"';
+        return result;
+    }
+
+    inline void write_csv(std::ostream& output, const std::vector<PerfResult>& results)
+    {
+        output << "name,samples,iterations,ns_per_op,low_ns_per_op,high_ns_per_op,std_dev_ns,items_per_call,samples_per_sec\n";
+        for (const auto& result : results)
+        {
+            output << csv_quoted(result.name) << ','
+                   << result.samples << ','
+                   << result.iterations << ','
+                   << result.mean_ns << ','
+                   << result.low_mean_ns << ','
+                   << result.high_mean_ns << ','
+                   << result.std_dev_ns << ','
+                   << result.items_per_call << ',';
+            // Left empty for benchmarks that process no samples.
+            if (result.has_samples_per_sec())
+                output << result.samples_per_sec();
+            output << '\n';
+        }
+        output.flush();
+    }
+
+    inline void write_json(std::ostream& output, const std::vector<PerfResult>& results)
+    {
+        output << "{\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const auto& result = results[i];
+            output << (i == 0 ? "\n" : ",\n")
+                   << "    {\"name\": " << json_quoted(result.name)
+                   << ", \"samples\": " << result.samples
+                   << ", \"iterations\": " << result.iterations
+                   << ", \"ns_per_op\": " << result.mean_ns
+                   << ", \"low_ns_per_op\": " << result.low_mean_ns
+                   << ", \"high_ns_per_op\": " << result.high_mean_ns
+                   << ", \"std_dev_ns\": " << result.std_dev_ns
+                   << ", \"items_per_call\": " << result.items_per_call
+                   << ", \"samples_per_sec\": ";
+            if (result.has_samples_per_sec())
+                output << result.samples_per_sec();
+            else
+                output << "null";
+            output << "}";
+        }
+        output << "\n  ]\n}\n";
+        output.flush();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/reporters/catch_reporter_streaming_base.hpp>
+
+#include <vector>
+
+#include "PerfReport.hpp"
+
+// Catch2 reporters that print only the benchmark numbers, in a form scripts can
+// diff between two builds:
+//     neuron_digits-benchmarks -r perf-csv -o results.csv
+//     neuron_digits-benchmarks -r perf-json -o results.json
+template<typename Writer>
+class PerfReporter : public Catch::StreamingReporterBase
+{
+public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override
+    {
+        PerfResult result;
+        result.name = stats.info.name;
+        result.samples = static_cast<int>(stats.info.samples);
+        result.iterations = static_cast<int>(stats.info.iterations);
+        result.mean_ns = stats.mean.point.count();
+        result.low_mean_ns = stats.mean.lower_bound.count();
+        result.high_mean_ns = stats.mean.upper_bound.count();
+        result.std_dev_ns = stats.standardDeviation.point.count();
+        result.items_per_call = perf::items_of(result.name);
+        m_results.push_back(result);
+    }
+
+    void testRunEnded(const Catch::TestRunStats& stats) override
+    {
+        StreamingReporterBase::testRunEnded(stats);
+        Writer::write(m_stream, m_results);
+    }
+
+private:
+    std::vector<PerfResult> m_results;
+};
+
+struct CsvWriter
+{
+    static void write(std::ostream& output, const std::vector<PerfResult>& results)
+    {
+        perf::write_csv(output, results);
+    }
+};
+
+struct JsonWriter
+{
+    static void write(std::ostream& output, const std::vector<PerfResult>& results)
+    {
+        perf::write_json(output, results);
+    }
+};
+
+class PerfCsvReporter : public PerfReporter<CsvWriter>
+{
+public:
+    using PerfReporter::PerfReporter;
+
+    static std::string getDescription()
+    {
+        return "Benchmark results as CSV: ns/op and samples/sec per benchmark";
+    }
+};
+
+class PerfJsonReporter : public PerfReporter<JsonWriter>
+{
+public:
+    using PerfReporter::PerfReporter;
+
+    static std::string getDescription()
+    {
+        return "Benchmark results as JSON: ns/op and samples/sec per benchmark";
+    }
+};
@@ -0,0 +1,11 @@
+#include <catch2/catch_session.hpp>
+
+#include "PerfReporters.hpp"
+
+CATCH_REGISTER_REPORTER("perf-csv", PerfCsvReporter)
+CATCH_REGISTER_REPORTER("perf-json", PerfJsonReporter)
+
+int main( int argc, char* argv[] ) 
+{
+  return Catch::Session().run( argc, argv );
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Dataset.hpp"
+#include "MappedFile.hpp"
+#include "SampleView.hpp"
+
+// Binary dataset file, little endian:
+//     BinaryDatasetHeader                    64 bytes
+//     labels, one uint8 per sample           at labels_offset, 64 byte aligned
+//     pixels, sample_size per sample         at pixels_offset, 64 byte aligned
+// Pixels of a sample are contiguous, as uint8 or float32 (see PixelType).
+struct BinaryDatasetHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t samples;
+    std::uint32_t sample_size;
+    std::uint32_t pixel_type;
+    std::uint64_t labels_offset;
+    std::uint64_t pixels_offset;
+    std::uint8_t reserved[24];
+};
+
+static_assert(sizeof(BinaryDatasetHeader) == 64, "The dataset header is 64 bytes on disk.");
+
+constexpr char BINARY_DATASET_MAGIC[4] = {'N', 'D', 'D', 'S'};
+constexpr std::uint32_t BINARY_DATASET_VERSION = 1;
+constexpr std::size_t BINARY_DATASET_ALIGNMENT = 64;
+
+inline std::size_t pixel_bytes(PixelType type)
+{
+    return type == PixelType::UInt8 ? sizeof(std::uint8_t) : sizeof(float);
+}
+
+// True when filename starts like a binary dataset, e.g. to tell it from a text one.
+inline bool is_binary_dataset(const std::string& filename)
+{
+    char magic[sizeof(BINARY_DATASET_MAGIC)] = {};
+    std::ifstream(filename, std::ios::binary).read(magic, sizeof(magic));
+    return std::memcmp(magic, BINARY_DATASET_MAGIC, sizeof(magic)) == 0;
+}
+
+// Throws unless header describes a dataset that fits in file_size bytes.
+inline void check_binary_dataset_header(const BinaryDatasetHeader& header, std::uint64_t file_size, const std::string& filename)
+{
+    if (std::memcmp(header.magic, BINARY_DATASET_MAGIC, sizeof(BINARY_DATASET_MAGIC)) != 0)
+        throw std::runtime_error("\"" + filename + "\" is not a binary dataset.");
+    if (header.version != BINARY_DATASET_VERSION)
+        throw std::runtime_error("\"" + filename + "\" has unsupported dataset version " + std::to_string(header.version) + ".");
+    if (header.pixel_type > static_cast<std::uint32_t>(PixelType::Float32))
+        throw std::runtime_error("\"" + filename + "\" has unknown pixel type.");
+
+    const std::uint64_t sample_bytes = static_cast<std::uint64_t>(header.sample_size) * pixel_bytes(static_cast<PixelType>(header.pixel_type));
+    const bool labels_fit = fits_in_file(header.labels_offset, header.samples, 1, file_size);
+    const bool pixels_fit = fits_in_file(header.pixels_offset, header.samples, sample_bytes, file_size);
+    if (not labels_fit or not pixels_fit or header.pixels_offset % BINARY_DATASET_ALIGNMENT != 0)
+        throw std::runtime_error("Truncated binary dataset \"" + filename + "\".");
+}
+
+// A binary dataset mapped into memory. Opening costs a few page faults whatever
+// the size of the file; samples are views into the mapping and nothing is copied
+// until a network reads its input.
+class BinaryDataset
+{
+public:
+    using value_type = std::pair<int, SampleView>;
+
+    explicit BinaryDataset(const std::string& filename)
+        : m_file(filename)
+    {
+        if (m_file.size() < sizeof(BinaryDatasetHeader))
+            throw std::runtime_error("\"" + filename + "\" is not a binary dataset.");
+
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        check_binary_dataset_header(m_header, m_file.size(), filename);
+
+        m_pixel_bytes = pixel_bytes(pixel_type());
+        m_labels = m_file.data() + m_header.labels_offset;
+        m_pixels = m_file.data() + m_header.pixels_offset;
+    }
+
+    std::size_t size() const
+    {
+        return m_header.samples;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    unsigned int sample_size() const
+    {
+        return m_header.sample_size;
+    }
+
+    PixelType pixel_type() const
+    {
+        return static_cast<PixelType>(m_header.pixel_type);
+    }
+
+    // Label and a view of the pixels of sample i.
+    value_type operator[](std::size_t i) const
+    {
+        return {m_labels[i], SampleView(m_pixels + i * m_header.sample_size * m_pixel_bytes, m_header.sample_size, pixel_type())};
+    }
+
+    value_type at(std::size_t i) const
+    {
+        if (i >= size())
+            throw std::runtime_error("BinaryDataset::at() sample " + std::to_string(i) + " is out of range.");
+        return (*this)[i];
+    }
+
+    // Hints the kernel to read ahead, for a front to back pass over the file.
+    void advise_sequential() const
+    {
+        m_file.advise_sequential();
+    }
+
+private:
+    MappedFile m_file;
+    BinaryDatasetHeader m_header;
+    std::size_t m_pixel_bytes = 0;
+    const std::uint8_t* m_labels = nullptr;
+    const std::uint8_t* m_pixels = nullptr;
+};
+
+// Writes data in the binary dataset format. With PixelType::UInt8 values are
+// rounded to the nearest k / 255; returns the largest error that introduced.
+inline float write_binary_dataset(const std::string& filename, const Dataset& data, PixelType type)
+{
+    std::ofstream output(filename, std::ios::binary);
+    if (not output)
+    {
+        throw std::runtime_error("Couldn't open file \"" + filename + "\".");
+    }
+
+    const auto aligned = [](std::uint64_t offset) {
+        return (offset + BINARY_DATASET_ALIGNMENT - 1) / BINARY_DATASET_ALIGNMENT * BINARY_DATASET_ALIGNMENT;
+    };
+
+    BinaryDatasetHeader header {};
+    std::memcpy(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic));
+    header.version = BINARY_DATASET_VERSION;
+    header.samples = data.size();
+    header.sample_size = data.empty() ? SAMPLE_SIZE : data.front().second.size();
+    header.pixel_type = static_cast<std::uint32_t>(type);
+    header.labels_offset = sizeof(header);
+    header.pixels_offset = aligned(header.labels_offset + header.samples);
+
+    std::vector<std::uint8_t> labels;
+    for (const auto& sample : data)
+    {
+        if (sample.first < 0 or sample.first > 255)
+            throw std::runtime_error("write_binary_dataset() label " + std::to_string(sample.first) + " doesn't fit a byte.");
+        if (sample.second.size() != header.sample_size)
+            throw std::runtime_error("write_binary_dataset() samples differ in size.");
+        labels.push_back(static_cast<std::uint8_t>(sample.first));
+    }
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(labels.data()), labels.size());
+    const std::vector<char> padding(header.pixels_offset - header.labels_offset - header.samples, 0);
+    output.write(padding.data(), padding.size());
+
+    float max_error = 0;
+    std::vector<std::uint8_t> bytes(header.sample_size);
+    for (const auto& sample : data)
+    {
+        if (type == PixelType::UInt8)
+        {
+            for (unsigned int i = 0; i < header.sample_size; i++)
+            {
+                const float value = sample.second[i] < 0 ? 0 : (sample.second[i] > 1 ? 1 : sample.second[i]);
+                bytes[i] = static_cast<std::uint8_t>(std::lround(value * 255));
+                max_error = std::max(max_error, std::abs(bytes[i] / 255.0f - sample.second[i]));
+            }
+            output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+        else
+        {
+            output.write(reinterpret_cast<const char*>(sample.second.data()), sample.second.size() * sizeof(float));
+        }
+    }
+
+    if (not output)
+        throw std::runtime_error("Couldn't write file \"" + filename + "\".");
+
+    return max_error;
+}
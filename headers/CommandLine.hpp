@@ -0,0 +1,118 @@
+#pragma once
+
+#include <initializer_list>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+// Arguments of a subcommand: `<program> <command> --name value --name=value --switch`.
+// A flag followed by another flag, or last on the line, is a switch with an empty value.
+class CommandLine
+{
+public:
+    CommandLine(int argc, const char* const* argv)
+    {
+        if (argc < 2)
+            throw std::runtime_error("CommandLine::CommandLine() no command given.");
+        m_command = argv[1];
+
+        for (int i = 2; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg.size() < 3 or arg.compare(0, 2, "--") != 0)
+                throw std::runtime_error("CommandLine::CommandLine() unexpected argument \"" + arg + "\".");
+
+            const auto equals = arg.find('=');
+            if (equals != std::string::npos)
+            {
+                m_values[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+            }
+            else if (i + 1 < argc and std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+            {
+                m_values[arg.substr(2)] = argv[i + 1];
+                i++;
+            }
+            else
+            {
+                m_values[arg.substr(2)] = "";
+            }
+        }
+    }
+
+    const std::string& command() const
+    {
+        return m_command;
+    }
+
+    bool has(const std::string& name) const
+    {
+        return m_values.count(name) != 0;
+    }
+
+    std::string value(const std::string& name, const std::string& fallback) const
+    {
+        const auto found = m_values.find(name);
+        return found != m_values.end() ? found->second : fallback;
+    }
+
+    unsigned int unsigned_value(const std::string& name, unsigned int fallback) const
+    {
+        if (not has(name))
+            return fallback;
+
+        const std::string text = value(name, "");
+        std::size_t parsed = 0;
+        unsigned long result = 0;
+        try
+        {
+            result = std::stoul(text, &parsed);
+        }
+        catch (const std::exception&)
+        {
+            parsed = 0;
+        }
+        if (parsed == 0 or parsed != text.size() or text[0] == '-' or result > 0xffffffffu)
+            throw std::runtime_error("CommandLine::unsigned_value() --" + name + " takes a number, not \"" + text + "\".");
+        return static_cast<unsigned int>(result);
+    }
+
+    double double_value(const std::string& name, double fallback) const
+    {
+        if (not has(name))
+            return fallback;
+
+        const std::string text = value(name, "");
+        std::size_t parsed = 0;
+        double result = 0;
+        try
+        {
+            result = std::stod(text, &parsed);
+        }
+        catch (const std::exception&)
+        {
+            parsed = 0;
+        }
+        if (parsed == 0 or parsed != text.size())
+            throw std::runtime_error("CommandLine::double_value() --" + name + " takes a number, not \"" + text + "\".");
+        return result;
+    }
+
+    // Throws on the first flag not in names, so a typo isn't silently replaced by a default.
+    void check_flags(std::initializer_list<const char*> names) const
+    {
+        for (const auto& flag : m_values)
+        {
+            bool known = false;
+            for (const char* name : names)
+            {
+                known = known or flag.first == name;
+            }
+            if (not known)
+                throw std::runtime_error("CommandLine::check_flags() unknown flag --" + flag.first + " for \"" + m_command + "\".");
+        }
+    }
+
+private:
+    std::string m_command;
+    std::map<std::string, std::string> m_values;
+};
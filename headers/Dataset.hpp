@@ -0,0 +1,41 @@
+#pragma once
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "TextParser.hpp"
+
+// Labelled samples: the right answer and its 28x28 pixels in [0, 1].
+using Dataset = std::vector<std::pair<int, std::vector<float>>>;
+
+constexpr unsigned int SAMPLE_SIZE = 784;
+
+// Reads the whitespace separated text format of lib_10k.txt: every sample is a
+// label followed by SAMPLE_SIZE pixel values. The file is parsed on `threads`
+// threads (0 takes every hardware thread, see parse_numbers()).
+inline Dataset read_text_dataset(const std::string& filename, std::size_t limit = std::numeric_limits<std::size_t>::max(), unsigned int threads = 0)
+{
+    constexpr std::size_t VALUES_PER_SAMPLE = SAMPLE_SIZE + 1;
+
+    const MappedFile file(filename);
+    const char* text = reinterpret_cast<const char*>(file.data());
+    const std::size_t max_count = limit < std::numeric_limits<std::size_t>::max() / VALUES_PER_SAMPLE ? limit * VALUES_PER_SAMPLE : std::numeric_limits<std::size_t>::max();
+    const auto values = parse_numbers<float>(text, text + file.size(), threads, max_count);
+
+    if (values.size() % VALUES_PER_SAMPLE != 0)
+        throw std::runtime_error("Truncated sample in \"" + filename + "\".");
+
+    Dataset result(values.size() / VALUES_PER_SAMPLE);
+    for (std::size_t i = 0; i < result.size(); i++)
+    {
+        const float* sample = values.data() + i * VALUES_PER_SAMPLE;
+        result[i].first = static_cast<int>(sample[0]);
+        result[i].second.assign(sample + 1, sample + VALUES_PER_SAMPLE);
+    }
+
+    return result;
+}
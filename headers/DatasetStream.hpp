@@ -0,0 +1,382 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BinaryDataset.hpp"
+#include "Dataset.hpp"
+#include "IdxDataset.hpp"
+#include "SampleView.hpp"
+
+// A run of consecutive samples read from a dataset file. Indexes like the
+// in-memory datasets, so trainers take a chunk as it is.
+struct SampleChunk
+{
+    using value_type = std::pair<int, SampleView>;
+
+    std::vector<int> labels;
+    std::vector<std::uint8_t> pixels;
+    unsigned int sample_size = 0;
+    PixelType pixel_type = PixelType::Float32;
+
+    std::size_t size() const
+    {
+        return labels.size();
+    }
+
+    bool empty() const
+    {
+        return labels.empty();
+    }
+
+    value_type operator[](std::size_t i) const
+    {
+        return {labels[i], SampleView(pixels.data() + i * sample_size * pixel_bytes(pixel_type), sample_size, pixel_type)};
+    }
+};
+
+// Source of chunks for DatasetStream; read() runs on the stream's I/O thread.
+class IChunkReader
+{
+public:
+    virtual ~IChunkReader() = default;
+
+    // Replaces chunk with up to max_samples next samples, returns how many were read.
+    // 0 means the end of the file.
+    virtual std::size_t read(SampleChunk& chunk, std::size_t max_samples) = 0;
+
+    // Starts over from the first sample.
+    virtual void rewind() = 0;
+};
+
+// Reads the binary dataset format (see BinaryDataset) with plain sequential reads.
+class BinaryChunkReader : public IChunkReader
+{
+public:
+    explicit BinaryChunkReader(const std::string& filename)
+        : m_labels(filename, std::ios::binary)
+        , m_pixels(filename, std::ios::binary)
+    {
+        if (not m_labels or not m_pixels)
+            throw std::runtime_error("Couldn't find file \"" + filename + "\".");
+
+        m_pixels.seekg(0, std::ios::end);
+        const auto file_size = static_cast<std::uint64_t>(m_pixels.tellg());
+        m_pixels.seekg(0);
+        if (file_size < sizeof(m_header) or not m_pixels.read(reinterpret_cast<char*>(&m_header), sizeof(m_header)))
+            throw std::runtime_error("\"" + filename + "\" is not a binary dataset.");
+        check_binary_dataset_header(m_header, file_size, filename);
+
+        rewind();
+    }
+
+    std::size_t read(SampleChunk& chunk, std::size_t max_samples) override
+    {
+        const std::size_t count = std::min<std::uint64_t>(max_samples, m_header.samples - m_position);
+        const std::size_t sample_bytes = m_header.sample_size * pixel_bytes(static_cast<PixelType>(m_header.pixel_type));
+
+        m_bytes.resize(count);
+        chunk.labels.resize(count);
+        chunk.pixels.resize(count * sample_bytes);
+        chunk.sample_size = m_header.sample_size;
+        chunk.pixel_type = static_cast<PixelType>(m_header.pixel_type);
+
+        m_labels.read(reinterpret_cast<char*>(m_bytes.data()), count);
+        m_pixels.read(reinterpret_cast<char*>(chunk.pixels.data()), chunk.pixels.size());
+        if (not m_labels or not m_pixels)
+            throw std::runtime_error("BinaryChunkReader::read() failed to read the file.");
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            chunk.labels[i] = m_bytes[i];
+        }
+        m_position += count;
+        return count;
+    }
+
+    void rewind() override
+    {
+        m_labels.clear();
+        m_pixels.clear();
+        m_labels.seekg(m_header.labels_offset);
+        m_pixels.seekg(m_header.pixels_offset);
+        m_position = 0;
+    }
+
+private:
+    std::ifstream m_labels;
+    std::ifstream m_pixels;
+    BinaryDatasetHeader m_header;
+    std::uint64_t m_position = 0;
+    std::vector<std::uint8_t> m_bytes;
+};
+
+// Reads the text format of lib_10k.txt (see read_text_dataset).
+class TextChunkReader : public IChunkReader
+{
+public:
+    explicit TextChunkReader(const std::string& filename)
+        : m_filename(filename)
+        , m_input(filename)
+    {
+        if (not m_input)
+            throw std::runtime_error("Couldn't find file \"" + filename + "\".");
+    }
+
+    std::size_t read(SampleChunk& chunk, std::size_t max_samples) override
+    {
+        chunk.labels.clear();
+        chunk.pixels.resize(max_samples * SAMPLE_SIZE * sizeof(float));
+        chunk.sample_size = SAMPLE_SIZE;
+        chunk.pixel_type = PixelType::Float32;
+
+        auto* pixels = reinterpret_cast<float*>(chunk.pixels.data());
+        int label;
+        while (chunk.labels.size() < max_samples)
+        {
+            // Only the end of the file ends a pass, anything else that isn't a label is an error.
+            if (not (m_input >> label))
+            {
+                if (not m_input.eof())
+                    throw std::runtime_error("Bad label in \"" + m_filename + "\".");
+                break;
+            }
+
+            float* sample = pixels + chunk.labels.size() * SAMPLE_SIZE;
+            for (unsigned int i = 0; i < SAMPLE_SIZE; i++)
+            {
+                m_input >> sample[i];
+            }
+
+            if (not m_input)
+                throw std::runtime_error("Truncated sample in \"" + m_filename + "\".");
+
+            chunk.labels.push_back(label);
+        }
+
+        chunk.pixels.resize(chunk.labels.size() * SAMPLE_SIZE * sizeof(float));
+        return chunk.labels.size();
+    }
+
+    void rewind() override
+    {
+        m_input.clear();
+        m_input.seekg(0);
+    }
+
+private:
+    std::string m_filename;
+    std::ifstream m_input;
+};
+
+// Copies chunks out of the mapped MNIST IDX files (see IdxDataset), which the
+// kernel reads ahead of the pass.
+class IdxChunkReader : public IChunkReader
+{
+public:
+    explicit IdxChunkReader(const std::string& images_filename)
+        : m_data(images_filename)
+    {
+        m_data.advise_sequential();
+    }
+
+    std::size_t read(SampleChunk& chunk, std::size_t max_samples) override
+    {
+        const std::size_t count = std::min(max_samples, m_data.size() - m_position);
+        chunk.labels.resize(count);
+        chunk.pixels.resize(count * m_data.sample_size());
+        chunk.sample_size = m_data.sample_size();
+        chunk.pixel_type = PixelType::UInt8;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const auto sample = m_data[m_position + i];
+            chunk.labels[i] = sample.first;
+            std::memcpy(chunk.pixels.data() + i * m_data.sample_size(), sample.second.data(), m_data.sample_size());
+        }
+        m_position += count;
+        return count;
+    }
+
+    void rewind() override
+    {
+        m_position = 0;
+    }
+
+private:
+    IdxDataset m_data;
+    std::size_t m_position = 0;
+};
+
+// IDX reader for MNIST images files (named like train-images-idx3-ubyte, the
+// labels file is found next to them), otherwise binary or text depending on the
+// file's contents.
+inline std::unique_ptr<IChunkReader> open_chunk_reader(const std::string& filename)
+{
+    if (filename.find("images-idx3") != std::string::npos)
+        return std::make_unique<IdxChunkReader>(filename);
+    if (is_binary_dataset(filename))
+        return std::make_unique<BinaryChunkReader>(filename);
+    return std::make_unique<TextChunkReader>(filename);
+}
+
+// Streams a dataset file pass after pass without loading it. A background thread
+// fills a ring of `buffers` chunks while the caller trains on the previous ones,
+// so memory stays at buffers * chunk_size samples whatever the file size.
+//
+//     DatasetStream stream(open_chunk_reader("lib_10k.bin"));
+//     while (const SampleChunk* chunk = stream.next())
+//         ...                      // one pass; next() then starts the following one
+//
+// A chunk stays valid until the following next() call.
+class DatasetStream
+{
+public:
+    struct Stats
+    {
+        std::size_t chunks = 0;
+        std::size_t samples = 0;
+        double read_seconds = 0;    // I/O thread busy reading
+        double stall_seconds = 0;   // caller blocked in next() waiting for a chunk
+    };
+
+    DatasetStream(std::unique_ptr<IChunkReader> reader, std::size_t chunk_size = 1024, unsigned int buffers = 3)
+        : m_reader(std::move(reader))
+        , m_chunk_size(chunk_size)
+        , m_chunks(buffers)
+    {
+        if (not m_reader)
+            throw std::runtime_error("DatasetStream::DatasetStream() reader is nullptr.");
+        if (chunk_size == 0 or buffers < 2)
+            throw std::runtime_error("DatasetStream::DatasetStream() needs a chunk size and at least two buffers.");
+
+        m_thread = std::thread(&DatasetStream::_read_loop, this);
+    }
+
+    DatasetStream(const DatasetStream&) = delete;
+    DatasetStream& operator=(const DatasetStream&) = delete;
+
+    ~DatasetStream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_free.notify_all();
+        m_thread.join();
+    }
+
+    // Next chunk of the current pass, nullptr when the pass is over. Blocks while
+    // the I/O thread is behind and rethrows its errors.
+    const SampleChunk* next()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_holding)
+        {
+            m_holding = false;
+            m_read_index++;
+            m_filled--;
+            m_free.notify_one();
+        }
+
+        if (m_filled == 0 and not m_error)
+        {
+            const auto start_point = std::chrono::steady_clock::now();
+            m_ready.wait(lock, [this] { return m_filled > 0 or m_error; });
+            const std::chrono::duration<double> stall = std::chrono::steady_clock::now() - start_point;
+            m_stats.stall_seconds += stall.count();
+        }
+        if (m_filled == 0)
+            std::rethrow_exception(m_error);
+
+        m_holding = true;
+        const SampleChunk& chunk = m_chunks[m_read_index % m_chunks.size()];
+        if (chunk.empty())
+            return nullptr;
+
+        m_stats.chunks++;
+        m_stats.samples += chunk.size();
+        return &chunk;
+    }
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    std::size_t chunk_size() const
+    {
+        return m_chunk_size;
+    }
+
+private:
+    void _read_loop()
+    {
+        std::size_t write_index = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_free.wait(lock, [this] { return m_stop or m_filled < m_chunks.size(); });
+                if (m_stop)
+                    return;
+            }
+
+            // The slot isn't visible to the caller until m_filled is raised.
+            SampleChunk& chunk = m_chunks[write_index % m_chunks.size()];
+            const auto start_point = std::chrono::steady_clock::now();
+            try
+            {
+                // An empty chunk marks the end of a pass.
+                if (m_reader->read(chunk, m_chunk_size) == 0)
+                    m_reader->rewind();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = std::current_exception();
+                m_ready.notify_one();
+                return;
+            }
+            const std::chrono::duration<double> read_time = std::chrono::steady_clock::now() - start_point;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stats.read_seconds += read_time.count();
+                m_filled++;
+            }
+            m_ready.notify_one();
+            write_index++;
+        }
+    }
+
+private:
+    std::unique_ptr<IChunkReader> m_reader;
+    std::size_t m_chunk_size;
+    std::vector<SampleChunk> m_chunks;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_free;
+    std::size_t m_read_index = 0;
+    std::size_t m_filled = 0;
+    bool m_holding = false;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+    Stats m_stats;
+
+    std::thread m_thread;
+};
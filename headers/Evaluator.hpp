@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "NeuroNet.hpp"
+#include "SampleView.hpp"
+#include "WorkerPool.hpp"
+
+// Measures a trained network on a labelled set. The set is cut into one contiguous
+// shard per worker, every worker runs analyze_batch() over its shard on its own
+// workspace and counts into its own confusion matrix; the matrices are summed once
+// all workers are done, so nothing is shared or locked while samples are analyzed.
+// Workspaces and score buffers are kept between calls, so evaluating again with the
+// same network allocates no matrices.
+template<typename T>
+class BasicEvaluator
+{
+public:
+    struct Report
+    {
+        std::size_t samples = 0;
+        unsigned int classes = 0;
+        unsigned int top_k = 1;
+        // Samples whose best output is their label, and whose label is among the top_k best.
+        std::size_t correct = 0;
+        std::size_t top_k_correct = 0;
+        // Samples with no answer, e.g. every output NaN. They count as wrong and are
+        // left out of the confusion matrix.
+        std::size_t invalid = 0;
+        double seconds = 0;
+        double samples_per_second = 0;
+        // classes x classes, the row is the label and the column the answer.
+        std::vector<std::size_t> confusion;
+
+        double accuracy() const
+        {
+            return samples ? correct / static_cast<double>(samples) : 0;
+        }
+
+        double top_k_accuracy() const
+        {
+            return samples ? top_k_correct / static_cast<double>(samples) : 0;
+        }
+
+        std::size_t count(unsigned int label, unsigned int answer) const
+        {
+            return confusion[label * classes + answer];
+        }
+
+        // Share of the samples of label that were answered right.
+        double recall(unsigned int label) const
+        {
+            std::size_t total = 0;
+            for (unsigned int answer = 0; answer < classes; answer++)
+            {
+                total += count(label, answer);
+            }
+            return total ? count(label, label) / static_cast<double>(total) : 0;
+        }
+
+        // Share of the answers label that were right.
+        double precision(unsigned int label) const
+        {
+            std::size_t total = 0;
+            for (unsigned int other = 0; other < classes; other++)
+            {
+                total += count(other, label);
+            }
+            return total ? count(label, label) / static_cast<double>(total) : 0;
+        }
+    };
+
+    // threads == 0 takes one worker per hardware thread. Every analyze_batch() call
+    // gets batch_size samples of a shard; top_k above 1 also reads the output scores.
+    BasicEvaluator(unsigned int threads = 0, unsigned int batch_size = 256, unsigned int top_k = 5)
+        : m_pool(threads)
+        , m_batch_size(batch_size)
+        , m_top_k(top_k)
+        , m_shards(m_pool.size())
+    {
+        if (m_batch_size == 0 or m_top_k == 0)
+            throw std::runtime_error("Evaluator::Evaluator() batch_size and top_k must be positive.");
+    }
+
+    unsigned int threads() const
+    {
+        return m_pool.size();
+    }
+
+    unsigned int batch_size() const
+    {
+        return m_batch_size;
+    }
+
+    // One pass of net over data, a Dataset or any container of (label, sample) pairs
+    // such as BinaryDataset. With latency, the time of every analyze_batch() call is
+    // recorded in it. Throws on a label the network has no output for.
+    template<typename Data>
+    Report evaluate(const BasicNeuroNet<T>& net, const Data& data, LatencyHistogram* latency = nullptr)
+    {
+        Report report;
+        report.samples = data.size();
+        report.classes = net.layers_sizes().back();
+        report.top_k = std::min(m_top_k, report.classes);
+        report.confusion.assign(report.classes * report.classes, 0);
+
+        const auto start_point = std::chrono::steady_clock::now();
+        m_pool.run([&](unsigned int worker) {
+            auto& shard = m_shards[worker];
+            shard.confusion.assign(report.confusion.size(), 0);
+            shard.top_k_correct = 0;
+            shard.invalid = 0;
+            // Sized for a whole batch up front, the short last batch of a shard reuses it.
+            if (report.top_k > 1 and shard.scores.size() != std::make_pair(m_batch_size, report.classes))
+                shard.scores = BasicMatrix<T>(m_batch_size, report.classes);
+
+            const std::size_t first = data.size() * worker / m_shards.size();
+            const std::size_t last = data.size() * (worker + 1) / m_shards.size();
+            for (std::size_t begin = first; begin < last; begin += m_batch_size)
+            {
+                const std::size_t count = std::min<std::size_t>(m_batch_size, last - begin);
+                _run_batch(net, data, begin, count, report, shard, latency);
+            }
+        });
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start_point;
+
+        for (const auto& shard : m_shards)
+        {
+            for (std::size_t i = 0; i < report.confusion.size(); i++)
+            {
+                report.confusion[i] += shard.confusion[i];
+            }
+            report.top_k_correct += shard.top_k_correct;
+            report.invalid += shard.invalid;
+        }
+        for (unsigned int label = 0; label < report.classes; label++)
+        {
+            report.correct += report.count(label, label);
+        }
+
+        report.seconds = spent.count();
+        report.samples_per_second = report.seconds > 0 ? report.samples / report.seconds : 0;
+        return report;
+    }
+
+private:
+    // Buffers and counts of one worker.
+    struct Shard
+    {
+        typename BasicNeuroNet<T>::AnalyzeWorkspace workspace;
+        BasicMatrix<T> scores = BasicMatrix<T>(0, 0);
+        std::vector<SampleView> inputs;
+        std::vector<int> answers;
+        std::vector<std::size_t> confusion;
+        std::size_t top_k_correct = 0;
+        std::size_t invalid = 0;
+    };
+
+    template<typename Data>
+    void _run_batch(const BasicNeuroNet<T>& net, const Data& data, std::size_t begin, std::size_t count, const Report& report, Shard& shard, LatencyHistogram* latency) const
+    {
+        shard.inputs.clear();
+        for (std::size_t i = begin; i < begin + count; i++)
+        {
+            shard.inputs.push_back(view_of(data[i].second));
+        }
+        shard.answers.resize(count);
+
+        const bool top_k = report.top_k > 1;
+        const auto sent = std::chrono::steady_clock::now();
+        net.analyze_batch(shard.inputs.data(), count, shard.answers.data(), top_k ? &shard.scores : nullptr, shard.workspace);
+        if (latency)
+            latency->record(std::chrono::duration<double>(std::chrono::steady_clock::now() - sent).count());
+
+        for (std::size_t b = 0; b < count; b++)
+        {
+            const int label = data[begin + b].first;
+            if (label < 0 or static_cast<unsigned int>(label) >= report.classes)
+                throw std::runtime_error("Evaluator::evaluate() label " + std::to_string(label) + " of sample " + std::to_string(begin + b) + " has no output.");
+
+            const int answer = shard.answers[b];
+            if (answer < 0 or static_cast<unsigned int>(answer) >= report.classes)
+            {
+                shard.invalid++;
+                continue;
+            }
+
+            shard.confusion[label * report.classes + answer]++;
+            if (not top_k)
+            {
+                shard.top_k_correct += answer == label;
+                continue;
+            }
+
+            // The label is in the top k when fewer than k outputs beat it.
+            const T label_score = shard.scores.unchecked(b, label);
+            unsigned int better = 0;
+            for (unsigned int i = 0; i < report.classes; i++)
+            {
+                better += shard.scores.unchecked(b, i) > label_score;
+            }
+            shard.top_k_correct += better < report.top_k;
+        }
+    }
+
+    WorkerPool m_pool;
+    const unsigned int m_batch_size;
+    const unsigned int m_top_k;
+    std::vector<Shard> m_shards;
+};
+
+using Evaluator = BasicEvaluator<float>;
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "IActivatorFunc.hpp"
+#include "NeuroNet.hpp"
+#include "kernels/Gemm.hpp"
+
+namespace detail
+{
+    template<unsigned int... Sizes>
+    constexpr unsigned int layer_size_at(std::size_t index)
+    {
+        constexpr unsigned int sizes[] = {Sizes...};
+        return sizes[index];
+    }
+}
+
+// Inference-only network whose topology is fixed at compile time, e.g.
+// BasicFixedNeuroNet<float, 784, 256, 10>. All buffers are statically sized and
+// aligned members, the kernels see constant dimensions and there are no size
+// checks on the hot path. Loads the same weight files as NeuroNet and runs the
+// same kernels, so predictions are identical.
+// Weights live inside the object: allocate it on the heap (std::make_unique), not the stack.
+template<typename T, unsigned int... Sizes>
+class BasicFixedNeuroNet
+{
+    static_assert(sizeof...(Sizes) >= 2, "A network needs at least an input and an output layer.");
+
+    template<unsigned int Size>
+    struct Neurons
+    {
+        alignas(64) std::array<T, Size> values;
+    };
+
+    template<std::size_t... I>
+    static auto _make_neurons(std::index_sequence<I...>)
+        -> std::tuple<Neurons<detail::layer_size_at<Sizes...>(I + 1)>...>;
+
+public:
+    using value_type = T;
+
+    static constexpr std::size_t LAYERS_COUNT = sizeof...(Sizes);
+    static constexpr unsigned int INPUT_SIZE = detail::layer_size_at<Sizes...>(0);
+    static constexpr unsigned int OUTPUT_SIZE = detail::layer_size_at<Sizes...>(LAYERS_COUNT - 1);
+
+    // Activations of one analyze(), statically sized like the weights but only a
+    // few KB. The network keeps one for the plain overloads; threads sharing a
+    // network pass their own.
+    struct Workspace
+    {
+        Neurons<INPUT_SIZE> input;
+        decltype(_make_neurons(std::make_index_sequence<LAYERS_COUNT - 1>{})) layers;
+    };
+
+    BasicFixedNeuroNet(std::weak_ptr<BasicActivatorFunc<T>> activator_func)
+        : m_activator(activator_func)
+    {}
+
+    static std::vector<unsigned int> layers_sizes()
+    {
+        return {Sizes...};
+    }
+
+    void read_weights(const std::string& filename)
+    {
+        BasicNeuroNet<T> net(layers_sizes(), m_activator);
+        net.read_weights(filename);
+        load(net);
+    }
+
+    // Copies the weights of a dynamic network with the same topology.
+    void load(const BasicNeuroNet<T>& net)
+    {
+        if (net.layers_sizes() != layers_sizes())
+            throw std::runtime_error("FixedNeuroNet::load() network topology doesn't match.");
+
+        _load<0>(net);
+    }
+
+    template<typename U>
+    int analyze(const std::vector<U>& input)
+    {
+        return analyze(input, m_workspace);
+    }
+
+    template<typename U>
+    int analyze(const std::vector<U>& input, Workspace& workspace) const
+    {
+        if (input.size() != INPUT_SIZE)
+            throw std::runtime_error("Input data size doesn't match the actual input layer size (" + std::to_string(input.size()) + " != " + std::to_string(INPUT_SIZE) + ").");
+
+        return analyze(input.data(), workspace);
+    }
+
+    // input points to INPUT_SIZE values.
+    template<typename U>
+    int analyze(const U* input)
+    {
+        return analyze(input, m_workspace);
+    }
+
+    template<typename U>
+    int analyze(const U* input, Workspace& workspace) const
+    {
+        const auto activator = m_activator.lock();
+        if (not activator)
+            throw std::runtime_error("Activator func is nulptr.");
+
+        for (unsigned int i = 0; i < INPUT_SIZE; i++)
+        {
+            workspace.input.values[i] = static_cast<T>(input[i]);
+        }
+
+        _forward<0>(*activator, workspace.input.values.data(), workspace);
+
+        const auto& output = std::get<LAYERS_COUNT - 2>(workspace.layers).values;
+        T max = -std::numeric_limits<T>::max();
+        int max_answer = -1;
+        for (unsigned int i = 0; i < OUTPUT_SIZE; i++)
+        {
+            if (output[i] > max)
+            {
+                max = output[i];
+                max_answer = i;
+            }
+        }
+        return max_answer;
+    }
+
+private:
+    template<unsigned int In, unsigned int Out>
+    struct Layer
+    {
+        static constexpr unsigned int INPUTS = In;
+        static constexpr unsigned int OUTPUTS = Out;
+
+        alignas(64) std::array<T, Out * In> weights;
+        alignas(64) std::array<T, Out> bioses;
+    };
+
+    template<std::size_t... I>
+    static auto _make_layers(std::index_sequence<I...>)
+        -> std::tuple<Layer<detail::layer_size_at<Sizes...>(I), detail::layer_size_at<Sizes...>(I + 1)>...>;
+
+    using Layers = decltype(_make_layers(std::make_index_sequence<LAYERS_COUNT - 1>{}));
+
+    template<std::size_t L>
+    void _forward(BasicActivatorFunc<T>& activator, const T* input, Workspace& workspace) const
+    {
+        const auto& layer = std::get<L>(m_layers);
+        using LayerType = std::decay_t<decltype(layer)>;
+        T* neurons = std::get<L>(workspace.layers).values.data();
+
+        kernels::gemv_fixed<LayerType::OUTPUTS, LayerType::INPUTS>(layer.weights.data(), LayerType::INPUTS, input, neurons, layer.bioses.data());
+        activator.func_inplace(neurons, LayerType::OUTPUTS);
+
+        if constexpr (L + 1 < LAYERS_COUNT - 1)
+            _forward<L + 1>(activator, neurons, workspace);
+    }
+
+    template<std::size_t L>
+    void _load(const BasicNeuroNet<T>& net)
+    {
+        auto& layer = std::get<L>(m_layers);
+        using LayerType = std::decay_t<decltype(layer)>;
+
+        const auto& weights = net.weights().at(L);
+        for (unsigned int i = 0; i < LayerType::OUTPUTS; i++)
+        {
+            const T* src = weights.row(i);
+            for (unsigned int j = 0; j < LayerType::INPUTS; j++)
+            {
+                layer.weights[i * LayerType::INPUTS + j] = src[j];
+            }
+            layer.bioses[i] = net.bioses().at(L)(i, 0);
+        }
+
+        if constexpr (L + 1 < LAYERS_COUNT - 1)
+            _load<L + 1>(net);
+    }
+
+private:
+    std::weak_ptr<BasicActivatorFunc<T>> m_activator;
+    Layers m_layers;
+    Workspace m_workspace;
+};
+
+template<unsigned int... Sizes>
+using FixedNeuroNet = BasicFixedNeuroNet<float, Sizes...>;
+
+// Topology of the deployed model (see weights256.txt).
+using DigitsNeuroNet = FixedNeuroNet<784, 256, 10>;
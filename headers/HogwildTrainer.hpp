@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "Dataset.hpp"
+#include "NeuroNet.hpp"
+#include "WorkerPool.hpp"
+
+// Asynchronous lock-free SGD (Hogwild!). Every worker pulls samples from a shared
+// cursor, runs analyze() and back_propagate() on its own SampleWorkspace and
+// writes the update straight into the shared weights, with no barrier or reduction
+// between samples. Updates of concurrent workers may overwrite each other, so the
+// result depends on scheduling; for sparse per-sample updates like these that costs
+// little accuracy and keeps every core busy. Use ParallelTrainer when the run must
+// be reproducible.
+template<typename T>
+class BasicHogwildTrainer
+{
+public:
+    // Samples a worker claims from the shared cursor at once, so the cursor's
+    // cache line isn't bounced between cores on every sample.
+    static constexpr std::size_t CLAIM_SIZE = 32;
+
+    struct Report
+    {
+        std::size_t samples = 0;
+        double seconds = 0;
+        double samples_per_second = 0;
+        // Share of samples answered right before their update, over the last epoch.
+        double last_epoch_accuracy = 0;
+    };
+
+    // threads == 0 takes one worker per hardware thread.
+    BasicHogwildTrainer(BasicNeuroNet<T>& net, unsigned int threads = 0)
+        : m_net(net)
+        , m_pool(threads)
+        , m_workspaces(m_pool.size())
+    {}
+
+    unsigned int threads() const
+    {
+        return m_pool.size();
+    }
+
+    // Runs epoches passes over data, every sample is backpropagated with study_coef.
+    // Data is a Dataset or any container of (label, sample) pairs such as BinaryDataset.
+    template<typename Data>
+    Report train(const Data& data, unsigned int epoches, double study_coef = 1)
+    {
+        Report report;
+        if (data.empty() or epoches == 0)
+            return report;
+
+        const std::size_t total = data.size() * epoches;
+        const std::size_t last_epoch = total - data.size();
+        std::atomic<std::size_t> cursor{0};
+        std::atomic<std::size_t> good{0};
+
+        const auto start_point = std::chrono::steady_clock::now();
+        m_pool.run([&](unsigned int worker) {
+            auto& workspace = m_workspaces[worker];
+            std::size_t worker_good = 0;
+
+            while (true)
+            {
+                const std::size_t first = cursor.fetch_add(CLAIM_SIZE, std::memory_order_relaxed);
+                if (first >= total)
+                    break;
+
+                const std::size_t last = std::min(first + CLAIM_SIZE, total);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    decltype(auto) sample = data[i % data.size()];
+                    const int answer = m_net.analyze(sample.second, workspace);
+                    if (i >= last_epoch and answer == sample.first)
+                        worker_good++;
+
+                    m_net.back_propagate(sample.first, study_coef, workspace);
+                }
+            }
+
+            good.fetch_add(worker_good, std::memory_order_relaxed);
+        });
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start_point;
+
+        report.samples = total;
+        report.seconds = spent.count();
+        report.samples_per_second = total / report.seconds;
+        report.last_epoch_accuracy = good.load() / static_cast<double>(data.size());
+        return report;
+    }
+
+private:
+    BasicNeuroNet<T>& m_net;
+    WorkerPool m_pool;
+    std::vector<typename BasicNeuroNet<T>::SampleWorkspace> m_workspaces;
+};
+
+using HogwildTrainer = BasicHogwildTrainer<float>;
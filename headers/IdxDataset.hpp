@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "MappedFile.hpp"
+#include "SampleView.hpp"
+
+// The upstream MNIST files (train-images-idx3-ubyte, train-labels-idx1-ubyte, ...)
+// mapped into memory. IDX is big endian:
+//     0x00 0x00 <type> <dimensions>         magic, type 0x08 is unsigned byte
+//     uint32 size per dimension
+//     data, row major
+// Pixels stay uint8 in the mapping (784 bytes per sample) and are normalised to
+// [0, 1] when a network reads its input, like BinaryDataset with PixelType::UInt8.
+class IdxDataset
+{
+public:
+    static constexpr std::uint8_t UNSIGNED_BYTE = 0x08;
+
+    using value_type = std::pair<int, SampleView>;
+
+    IdxDataset(const std::string& images_filename, const std::string& labels_filename)
+        : m_images(images_filename)
+        , m_labels(labels_filename)
+    {
+        const auto images = _parse(m_images, images_filename);
+        const auto labels = _parse(m_labels, labels_filename);
+
+        if (images.dimensions < 2)
+            throw std::runtime_error("\"" + images_filename + "\" holds no images.");
+        if (labels.dimensions != 1)
+            throw std::runtime_error("\"" + labels_filename + "\" holds no labels.");
+        if (images.count != labels.count)
+            throw std::runtime_error("\"" + images_filename + "\" and \"" + labels_filename + "\" differ in sample count.");
+
+        m_size = images.count;
+        m_sample_size = static_cast<unsigned int>(images.item_size);
+        m_pixels = images.data;
+        m_label_data = labels.data;
+    }
+
+    // Takes the labels file name from the images one, e.g. train-images-idx3-ubyte
+    // and train-labels-idx1-ubyte.
+    explicit IdxDataset(const std::string& images_filename)
+        : IdxDataset(images_filename, labels_filename_for(images_filename))
+    {}
+
+    static std::string labels_filename_for(const std::string& images_filename)
+    {
+        std::string result = images_filename;
+        const auto images = result.rfind("images-idx3");
+        if (images == std::string::npos)
+            throw std::runtime_error("IdxDataset::labels_filename_for() \"" + images_filename + "\" isn't named like an MNIST images file.");
+        result.replace(images, 11, "labels-idx1");
+        return result;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    unsigned int sample_size() const
+    {
+        return m_sample_size;
+    }
+
+    PixelType pixel_type() const
+    {
+        return PixelType::UInt8;
+    }
+
+    // Label and a view of the pixels of sample i.
+    value_type operator[](std::size_t i) const
+    {
+        return {m_label_data[i], SampleView(m_pixels + i * m_sample_size, m_sample_size, PixelType::UInt8)};
+    }
+
+    value_type at(std::size_t i) const
+    {
+        if (i >= size())
+            throw std::runtime_error("IdxDataset::at() sample " + std::to_string(i) + " is out of range.");
+        return (*this)[i];
+    }
+
+    // Hints the kernel to read ahead, for a front to back pass over the files.
+    void advise_sequential() const
+    {
+        m_images.advise_sequential();
+        m_labels.advise_sequential();
+    }
+
+private:
+    struct Contents
+    {
+        unsigned int dimensions;
+        std::size_t count;
+        std::size_t item_size;
+        const std::uint8_t* data;
+    };
+
+    static std::uint32_t _read_big_endian(const std::uint8_t* bytes)
+    {
+        return (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | std::uint32_t(bytes[3]);
+    }
+
+    static Contents _parse(const MappedFile& file, const std::string& filename)
+    {
+        const std::uint8_t* bytes = file.data();
+        if (file.size() < 8 or bytes[0] != 0 or bytes[1] != 0 or bytes[3] == 0)
+            throw std::runtime_error("\"" + filename + "\" is not an IDX file.");
+        if (bytes[2] != UNSIGNED_BYTE)
+            throw std::runtime_error("\"" + filename + "\" doesn't hold unsigned bytes.");
+
+        Contents result;
+        result.dimensions = bytes[3];
+        const std::size_t header_size = 4 + 4 * std::size_t(result.dimensions);
+        if (file.size() < header_size)
+            throw std::runtime_error("Truncated IDX file \"" + filename + "\".");
+
+        result.count = _read_big_endian(bytes + 4);
+        // Every product is checked against the file size before it is made, so
+        // crafted dimensions can't wrap around and pass as a small file.
+        result.item_size = 1;
+        for (unsigned int i = 1; i < result.dimensions; i++)
+        {
+            const std::size_t size = _read_big_endian(bytes + 4 + 4 * i);
+            if (size != 0 and result.item_size > file.size() / size)
+                throw std::runtime_error("Truncated IDX file \"" + filename + "\".");
+            result.item_size *= size;
+        }
+        if (not fits_in_file(header_size, result.count, result.item_size, file.size()))
+            throw std::runtime_error("Truncated IDX file \"" + filename + "\".");
+
+        result.data = bytes + header_size;
+        return result;
+    }
+
+private:
+    MappedFile m_images;
+    MappedFile m_labels;
+    std::size_t m_size = 0;
+    unsigned int m_sample_size = 0;
+    const std::uint8_t* m_pixels = nullptr;
+    const std::uint8_t* m_label_data = nullptr;
+};
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "MicroBatcher.hpp"
+
+// Local socket service in front of a MicroBatcher. Every connection runs one
+// request at a time, clients open several connections to have requests in flight
+// together; the batcher gathers them across connections. Host byte order, the
+// service is meant for the local machine:
+//     request   uint32 kind
+//               kind == CLASSIFY: uint32 size, then size uint8 pixels
+//     reply     CLASSIFY: int32 answer, -1 if the request was rejected
+//               STATS:    ServingStats
+enum class ServerRequest : std::uint32_t
+{
+    Classify = 1,
+    Stats = 2,
+};
+
+static_assert(std::is_trivially_copyable_v<ServingStats>, "ServingStats goes over the wire as it is.");
+
+// "unix:<path>" or "tcp:<host>:<port>"; a bare "<host>:<port>" or "<port>" is TCP.
+// TCP without a host listens on 127.0.0.1 only.
+struct Endpoint
+{
+    enum class Kind
+    {
+        Unix,
+        Tcp,
+    };
+
+    Kind kind = Kind::Tcp;
+    std::string path;
+    std::string host = "127.0.0.1";
+    unsigned short port = 0;
+
+    static Endpoint parse(const std::string& text)
+    {
+        Endpoint result;
+        if (text.rfind("unix:", 0) == 0)
+        {
+            result.kind = Kind::Unix;
+            result.path = text.substr(5);
+            if (result.path.empty() or result.path.size() >= sizeof(sockaddr_un::sun_path))
+                throw std::runtime_error("Bad unix socket path in \"" + text + "\".");
+            return result;
+        }
+
+        std::string address = text.rfind("tcp:", 0) == 0 ? text.substr(4) : text;
+        const auto colon = address.rfind(':');
+        if (colon != std::string::npos)
+        {
+            result.host = address.substr(0, colon);
+            address = address.substr(colon + 1);
+        }
+
+        try
+        {
+            const auto port = std::stoul(address);
+            if (port > 65535)
+                throw std::out_of_range("port");
+            result.port = static_cast<unsigned short>(port);
+        }
+        catch (const std::logic_error&)
+        {
+            throw std::runtime_error("Bad endpoint \"" + text + "\", expected unix:<path> or tcp:<host>:<port>.");
+        }
+        return result;
+    }
+
+    std::string to_string() const
+    {
+        return kind == Kind::Unix ? "unix:" + path : "tcp:" + host + ":" + std::to_string(port);
+    }
+};
+
+namespace detail
+{
+    inline std::runtime_error socket_error(const std::string& what)
+    {
+        return std::runtime_error(what + ": " + std::strerror(errno) + ".");
+    }
+
+    // Whole writes and reads; false when the peer is gone.
+    inline bool send_all(int fd, const void* data, std::size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            const ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent < 0 and errno == EINTR)
+                continue;
+            if (sent <= 0)
+                return false;
+            bytes += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    inline bool receive_all(int fd, void* data, std::size_t size)
+    {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0)
+        {
+            const ssize_t received = ::recv(fd, bytes, size, 0);
+            if (received < 0 and errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            bytes += received;
+            size -= received;
+        }
+        return true;
+    }
+
+    // A socket of endpoint's family with its address filled in.
+    inline int open_socket(const Endpoint& endpoint, sockaddr_storage& address, socklen_t& length)
+    {
+        std::memset(&address, 0, sizeof(address));
+        if (endpoint.kind == Endpoint::Kind::Unix)
+        {
+            auto& unix_address = reinterpret_cast<sockaddr_un&>(address);
+            unix_address.sun_family = AF_UNIX;
+            std::strncpy(unix_address.sun_path, endpoint.path.c_str(), sizeof(unix_address.sun_path) - 1);
+            length = sizeof(sockaddr_un);
+        }
+        else
+        {
+            auto& inet_address = reinterpret_cast<sockaddr_in&>(address);
+            inet_address.sin_family = AF_INET;
+            inet_address.sin_port = htons(endpoint.port);
+            if (inet_pton(AF_INET, endpoint.host.c_str(), &inet_address.sin_addr) != 1)
+                throw std::runtime_error("Bad IPv4 address \"" + endpoint.host + "\".");
+            length = sizeof(sockaddr_in);
+        }
+
+        const int fd = ::socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw socket_error("Couldn't create a socket for " + endpoint.to_string());
+        return fd;
+    }
+
+    // Requests and replies are a few bytes, don't hold them back for coalescing.
+    inline void set_no_delay(int fd, const Endpoint& endpoint)
+    {
+        if (endpoint.kind == Endpoint::Kind::Tcp)
+        {
+            const int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+    }
+}
+
+// Listens on endpoint from the constructor on; run() serves until stop().
+class InferenceServer
+{
+public:
+    InferenceServer(MicroBatcher& batcher, const Endpoint& endpoint)
+        : m_batcher(batcher)
+        , m_endpoint(endpoint)
+    {
+        sockaddr_storage address;
+        socklen_t length;
+        m_listener = detail::open_socket(m_endpoint, address, length);
+
+        if (m_endpoint.kind == Endpoint::Kind::Unix)
+        {
+            // A socket left behind by an earlier server is replaced, any other file is kept.
+            struct stat status;
+            if (::lstat(m_endpoint.path.c_str(), &status) == 0)
+            {
+                if (not S_ISSOCK(status.st_mode))
+                {
+                    ::close(m_listener);
+                    throw std::runtime_error("Couldn't listen on " + m_endpoint.to_string() + ": the path exists and is not a socket.");
+                }
+                ::unlink(m_endpoint.path.c_str());
+            }
+        }
+        else
+        {
+            const int enable = 1;
+            ::setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        }
+
+        if (::bind(m_listener, reinterpret_cast<sockaddr*>(&address), length) != 0 or ::listen(m_listener, SOMAXCONN) != 0)
+        {
+            const auto error = detail::socket_error("Couldn't listen on " + m_endpoint.to_string());
+            ::close(m_listener);
+            throw error;
+        }
+
+        // Port 0 asks the system for a free one.
+        if (m_endpoint.kind == Endpoint::Kind::Tcp and m_endpoint.port == 0)
+        {
+            sockaddr_in bound {};
+            socklen_t bound_length = sizeof(bound);
+            ::getsockname(m_listener, reinterpret_cast<sockaddr*>(&bound), &bound_length);
+            m_endpoint.port = ntohs(bound.sin_port);
+        }
+    }
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    ~InferenceServer()
+    {
+        stop();
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        for (auto& connection : m_connections)
+        {
+            connection->thread.join();
+            ::close(connection->fd);
+        }
+        ::close(m_listener);
+        if (m_endpoint.kind == Endpoint::Kind::Unix)
+            ::unlink(m_endpoint.path.c_str());
+    }
+
+    // The endpoint actually listened on, with the port the system picked.
+    const Endpoint& endpoint() const
+    {
+        return m_endpoint;
+    }
+
+    // Accepts connections until stop(), each is served on a thread of its own.
+    void run()
+    {
+        while (not m_stopped.load())
+        {
+            const int fd = ::accept4(m_listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno == EINTR or errno == ECONNABORTED)
+                    continue;
+                if (m_stopped.load())
+                    break;
+                throw detail::socket_error("Couldn't accept on " + m_endpoint.to_string());
+            }
+            detail::set_no_delay(fd, m_endpoint);
+
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            _reap_connections();
+            if (m_stopped.load())
+            {
+                ::close(fd);
+                break;
+            }
+            auto connection = std::make_unique<Connection>();
+            connection->fd = fd;
+            connection->thread = std::thread(&InferenceServer::_serve, this, connection.get());
+            m_connections.push_back(std::move(connection));
+        }
+    }
+
+    // Makes run() return and hangs up every connection. Safe from any thread.
+    void stop()
+    {
+        if (m_stopped.exchange(true))
+            return;
+
+        ::shutdown(m_listener, SHUT_RDWR);
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        for (auto& connection : m_connections)
+        {
+            ::shutdown(connection->fd, SHUT_RDWR);
+        }
+    }
+
+private:
+    struct Connection
+    {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done {false};
+    };
+
+    void _serve(Connection* connection)
+    {
+        const int fd = connection->fd;
+        std::vector<std::uint8_t> pixels;
+        while (true)
+        {
+            std::uint32_t kind;
+            if (not detail::receive_all(fd, &kind, sizeof(kind)))
+                break;
+
+            if (kind == static_cast<std::uint32_t>(ServerRequest::Stats))
+            {
+                const auto stats = m_batcher.stats();
+                if (not detail::send_all(fd, &stats, sizeof(stats)))
+                    break;
+                continue;
+            }
+            if (kind != static_cast<std::uint32_t>(ServerRequest::Classify))
+                break;
+
+            std::uint32_t size;
+            if (not detail::receive_all(fd, &size, sizeof(size)) or size > MAX_PIXELS)
+                break;
+            pixels.resize(size);
+            if (not detail::receive_all(fd, pixels.data(), size))
+                break;
+
+            std::int32_t answer = -1;
+            if (size == m_batcher.input_size())
+            {
+                try
+                {
+                    answer = m_batcher.submit(std::move(pixels)).get();
+                }
+                catch (const std::exception&)
+                {
+                    answer = -1;
+                }
+            }
+            if (not detail::send_all(fd, &answer, sizeof(answer)))
+                break;
+        }
+        connection->done.store(true);
+    }
+
+    // Joins the threads of closed connections; m_connections_mutex is held.
+    void _reap_connections()
+    {
+        for (auto it = m_connections.begin(); it != m_connections.end();)
+        {
+            if ((*it)->done.load())
+            {
+                (*it)->thread.join();
+                ::close((*it)->fd);
+                it = m_connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // Anything bigger is not an image, the connection is dropped.
+    static constexpr std::uint32_t MAX_PIXELS = 1 << 20;
+
+    MicroBatcher& m_batcher;
+    Endpoint m_endpoint;
+    int m_listener = -1;
+    std::atomic<bool> m_stopped {false};
+
+    std::mutex m_connections_mutex;
+    std::list<std::unique_ptr<Connection>> m_connections;
+};
+
+// Blocking client of one connection to an InferenceServer.
+class InferenceClient
+{
+public:
+    explicit InferenceClient(const Endpoint& endpoint)
+    {
+        sockaddr_storage address;
+        socklen_t length;
+        m_fd = detail::open_socket(endpoint, address, length);
+        if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), length) != 0)
+        {
+            const auto error = detail::socket_error("Couldn't connect to " + endpoint.to_string());
+            ::close(m_fd);
+            throw error;
+        }
+        detail::set_no_delay(m_fd, endpoint);
+    }
+
+    InferenceClient(const InferenceClient&) = delete;
+    InferenceClient& operator=(const InferenceClient&) = delete;
+
+    ~InferenceClient()
+    {
+        ::close(m_fd);
+    }
+
+    // The network's answer for size uint8 pixels, -1 if the server rejected them.
+    int classify(const std::uint8_t* pixels, std::uint32_t size)
+    {
+        std::vector<std::uint8_t> message(2 * sizeof(std::uint32_t) + size);
+        const auto kind = static_cast<std::uint32_t>(ServerRequest::Classify);
+        std::memcpy(message.data(), &kind, sizeof(kind));
+        std::memcpy(message.data() + sizeof(kind), &size, sizeof(size));
+        std::memcpy(message.data() + 2 * sizeof(std::uint32_t), pixels, size);
+
+        std::int32_t answer;
+        if (not detail::send_all(m_fd, message.data(), message.size()) or not detail::receive_all(m_fd, &answer, sizeof(answer)))
+            throw std::runtime_error("InferenceClient::classify() connection lost.");
+        return answer;
+    }
+
+    ServingStats stats()
+    {
+        const auto kind = static_cast<std::uint32_t>(ServerRequest::Stats);
+        ServingStats result;
+        if (not detail::send_all(m_fd, &kind, sizeof(kind)) or not detail::receive_all(m_fd, &result, sizeof(result)))
+            throw std::runtime_error("InferenceClient::stats() connection lost.");
+        return result;
+    }
+
+private:
+    int m_fd = -1;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Histogram of durations for latency percentiles. Buckets are log-linear: every
+// power of two nanoseconds is split into 16 equal steps, so a percentile is off
+// by at most 1/16 of its value, from 1ns up to 2^40ns (about 18 minutes). Slower
+// values land in the last bucket. record() is two relaxed atomic increments,
+// so any number of threads may record while others read percentiles.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned int SUB_BUCKET_BITS = 4;
+    static constexpr unsigned int SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned int OCTAVES = 40;
+    static constexpr unsigned int BUCKETS_COUNT = (OCTAVES - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(double seconds)
+    {
+        const double nanoseconds = seconds * 1e9;
+        const std::uint64_t value = nanoseconds < 1 ? 0 : (nanoseconds >= MAX_VALUE ? MAX_VALUE : static_cast<std::uint64_t>(nanoseconds));
+        m_buckets[_bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    // The smallest bucket bound that at least fraction of the values (0..1) are
+    // below, in seconds; 0 when nothing was recorded.
+    double percentile(double fraction) const
+    {
+        std::uint64_t total = 0;
+        std::array<std::uint64_t, BUCKETS_COUNT> counts;
+        for (unsigned int i = 0; i < BUCKETS_COUNT; i++)
+        {
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0)
+            return 0;
+
+        const double rank = fraction * total;
+        std::uint64_t seen = 0;
+        for (unsigned int i = 0; i < BUCKETS_COUNT; i++)
+        {
+            seen += counts[i];
+            if (seen > 0 and seen >= rank)
+                return _upper_bound(i) * 1e-9;
+        }
+        return _upper_bound(BUCKETS_COUNT - 1) * 1e-9;
+    }
+
+    void reset()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << OCTAVES) - 1;
+
+    // Values below SUB_BUCKETS get a bucket each; above, the leading bit picks the
+    // octave and the SUB_BUCKET_BITS after it the step within the octave.
+    static unsigned int _bucket_of(std::uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return static_cast<unsigned int>(value);
+
+        unsigned int leading = 63;
+        while (not (value >> leading))
+        {
+            leading--;
+        }
+        const unsigned int octave = leading - SUB_BUCKET_BITS + 1;
+        const unsigned int step = static_cast<unsigned int>(value >> (leading - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return octave * SUB_BUCKETS + step;
+    }
+
+    // Largest value, in nanoseconds, that falls in bucket.
+    static double _upper_bound(unsigned int bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        const unsigned int octave = bucket / SUB_BUCKETS;
+        const unsigned int step = bucket % SUB_BUCKETS;
+        const double width = static_cast<double>(std::uint64_t(1) << (octave - 1));
+        return (SUB_BUCKETS + step + 1) * width - 1;
+    }
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS_COUNT> m_buckets;
+    std::atomic<std::uint64_t> m_count {0};
+};
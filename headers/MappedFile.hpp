@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Memory mapping of a whole file. Pages are loaded by the kernel on first touch
+// and shared with the page cache, so opening is O(1) in the file size.
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        ReadOnly,
+        CopyOnWrite,    // writable; a written page becomes a private copy, the file never changes
+    };
+
+    explicit MappedFile(const std::string& filename, Access access = Access::ReadOnly)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Couldn't find file \"" + filename + "\".");
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Couldn't stat file \"" + filename + "\".");
+        }
+
+        m_size = static_cast<std::size_t>(info.st_size);
+        if (m_size > 0)
+        {
+            const int protection = access == Access::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+            void* data = ::mmap(nullptr, m_size, protection, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Couldn't map file \"" + filename + "\".");
+            }
+            m_data = static_cast<std::uint8_t*>(data);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        if (m_data)
+            ::munmap(m_data, m_size);
+    }
+
+    const std::uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    // Only writable with Access::CopyOnWrite.
+    std::uint8_t* data()
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    // Tells the kernel the mapping will be read front to back, so it reads ahead.
+    void advise_sequential() const
+    {
+        if (m_data)
+            ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+    }
+
+private:
+    std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+// True when count items of item_size bytes starting at offset end within a file of
+// file_size bytes. Compares against the space left instead of computing the end, so
+// sizes read from a corrupt or crafted header can't wrap around and pass.
+inline bool fits_in_file(std::uint64_t offset, std::uint64_t count, std::uint64_t item_size, std::uint64_t file_size)
+{
+    if (offset > file_size)
+        return false;
+    return item_size == 0 or count <= (file_size - offset) / item_size;
+}
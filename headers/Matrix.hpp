@@ -1,52 +1,104 @@
 #pragma once
 
+#include <vector>
 #include <utility>
 #include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+
+#include "MatrixExpr.hpp"
+#include "kernels/Gemm.hpp"
+
+// Bounds checking of Matrix::operator() is a debug aid, kernels must not pay for it.
+// Define MATRIX_BOUNDS_CHECK explicitly to keep the checks in optimized builds.
+#if not defined(MATRIX_BOUNDS_CHECK) and not defined(NDEBUG)
+#define MATRIX_BOUNDS_CHECK
+#endif
+
+namespace detail
+{
+    // Shared by every element type, see BasicMatrix::allocation_count().
+    inline std::atomic<std::size_t> matrix_allocations { 0 };
+}
 
-class Matrix
+template<typename T>
+class BasicMatrix : public MatrixExpr<BasicMatrix<T>>
 {
 public:
+    using value_type = T;
     using Rows = unsigned int;
     using Cols = unsigned int;
     using MatrixSize = std::pair<Rows, Cols>;
 
-    Matrix(unsigned int rows, unsigned int cols, double default_values = 0)
+    // Every row starts on a cache line boundary, so SIMD kernels may use aligned loads.
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    BasicMatrix(unsigned int rows, unsigned int cols, T default_values = 0)
     {
         _resize(rows, cols, default_values);
     }
 
-    Matrix(const std::vector<double>& lhl)
+    BasicMatrix(const std::vector<T>& lhl)
     {
-        _resize(lhl.size(), 1);
-        
-        for (int i = 0; i < lhl.size(); i++)
-        {
-            this->operator()(i, 0) = lhl.at(i);
-        }
+        _reshape(lhl.size(), 1);
+        std::memcpy(m_data, lhl.data(), lhl.size() * sizeof(T));
+    }
+
+    BasicMatrix(const BasicMatrix& lhl)
+    {
+        _copy_from(lhl);
+    }
+
+    BasicMatrix(BasicMatrix&& lhl) noexcept
+    {
+        _swap(lhl);
     }
 
-    Matrix(const Matrix& lhl)
+    template<typename E>
+    BasicMatrix(const MatrixExpr<E>& lhl)
     {
         const auto lhl_size = lhl.size();
-        _resize(lhl_size.first, lhl_size.second);
-        
-        for (int i = 0; i < lhl_size.first; i++)
-        {
-            for (int j = 0; j < lhl_size.second; j++)
-            {
-                this->operator()(i, j) = lhl(i, j);
-            }
-        }
+        _reshape(lhl_size.first, lhl_size.second);
+        _assign(lhl.self());
+    }
+
+    ~BasicMatrix()
+    {
+        if (m_owns_data)
+            std::free(m_data);
+    }
+
+    // A matrix over memory it doesn't own, e.g. weights in a mapped file. data must
+    // outlive the view and have room for rows * stride elements. Writes go to data;
+    // copies of a view and reshapes that need more room allocate their own buffer.
+    static BasicMatrix view(T* data, unsigned int rows, unsigned int cols, unsigned int stride)
+    {
+        if (stride < cols or (cols > 1 and reinterpret_cast<std::uintptr_t>(data) % ALIGNMENT != 0))
+            throw std::runtime_error("Matrix::view() stride or alignment doesn't fit the matrix.");
+
+        BasicMatrix result(0, 0);
+        result.m_data = data;
+        result.m_rows = rows;
+        result.m_cols = cols;
+        result.m_stride = stride;
+        result.m_capacity = static_cast<std::size_t>(rows) * stride;
+        result.m_owns_data = false;
+        return result;
+    }
+
+    bool owns_data() const
+    {
+        return m_owns_data;
     }
-    
-    ~Matrix()
+
+    // Number of buffers matrices of any element type have allocated in this process,
+    // lets tests prove that a code path reuses the storage it already has.
+    static std::size_t allocation_count()
     {
-        // if (m_matrix != nullptr)
-        // {
-        //     for (int i = 0; i < m_rows; i++)
-        //         delete m_matrix[i];
-        //     delete m_matrix;
-        // }
+        return detail::matrix_allocations.load(std::memory_order_relaxed);
     }
 
     MatrixSize size() const
@@ -54,169 +106,322 @@ public:
         return {m_rows, m_cols};
     }
 
-    static Matrix transponate(const Matrix& lhl)
+    // Sets the shape, keeping the buffer when it already has room for it. Element
+    // values are left unspecified, only the row padding is cleared.
+    void reshape(unsigned int rows, unsigned int cols)
+    {
+        _reshape(rows, cols);
+    }
+
+    // Stride of the rows of a matrix with cols columns that owns its buffer.
+    static unsigned int natural_stride(unsigned int cols)
+    {
+        // Column vectors stay dense, so a Nx1 matrix is a plain contiguous array.
+        if (cols <= 1)
+            return cols;
+
+        constexpr unsigned int align_elems = ALIGNMENT / sizeof(T);
+        return (cols + align_elems - 1) / align_elems * align_elems;
+    }
+
+    // Distance in elements between the starts of two neighbouring rows.
+    unsigned int stride() const
     {
+        return m_stride;
+    }
+
+    T* data()
+    {
+        return m_data;
+    }
+
+    const T* data() const
+    {
+        return m_data;
+    }
+
+    T* row(unsigned int i)
+    {
+        return m_data + static_cast<std::size_t>(i) * m_stride;
+    }
+
+    const T* row(unsigned int i) const
+    {
+        return m_data + static_cast<std::size_t>(i) * m_stride;
+    }
+
+    static BasicMatrix transponate(const BasicMatrix& lhl)
+    {
+        BasicMatrix result(0, 0);
+        transponate(lhl, result);
+
+        return result;
+    }
+
+    // Writes the transposition into result, reusing its buffer.
+    static void transponate(const BasicMatrix& lhl, BasicMatrix& result)
+    {
+        // Square tiles keep both the rows read and the rows written in L1; a whole
+        // column of result would evict itself since the strides are powers of two.
+        constexpr unsigned int TILE = 16;
+
         const auto orig_size = lhl.size();
-        Matrix result(orig_size.second, orig_size.first);
+        result._reshape(orig_size.second, orig_size.first);
 
-        for (auto i = 0; i < orig_size.first; i++)
+        for (unsigned int ii = 0; ii < orig_size.first; ii += TILE)
         {
-            for (auto j = 0; j < orig_size.second; j++)
+            const unsigned int i_end = std::min(ii + TILE, orig_size.first);
+            for (unsigned int jj = 0; jj < orig_size.second; jj += TILE)
             {
-                result(j, i) = lhl(i, j);
+                const unsigned int j_end = std::min(jj + TILE, orig_size.second);
+                for (unsigned int i = ii; i < i_end; i++)
+                {
+                    const T* src = lhl.row(i);
+                    for (unsigned int j = jj; j < j_end; j++)
+                    {
+                        result.unchecked(j, i) = src[j];
+                    }
+                }
             }
         }
+    }
 
-        return result;
+    // result = lhs * rhs, reusing the buffer of result. result must not alias an operand.
+    static void multiply(const BasicMatrix& lhs, const BasicMatrix& rhs, BasicMatrix& result)
+    {
+        if (lhs.m_cols != rhs.m_rows)
+            throw std::runtime_error("Matrix::operator*() Matrixes are not compatible.");
+
+        result._reshape(lhs.m_rows, rhs.m_cols);
+        if (rhs.m_cols == 1)
+        {
+            kernels::gemv(lhs.m_rows, lhs.m_cols, lhs.m_data, lhs.m_stride, rhs.m_data, result.m_data);
+        }
+        else
+        {
+            kernels::gemm(lhs.m_rows, rhs.m_cols, lhs.m_cols, lhs.m_data, lhs.m_stride, rhs.m_data, rhs.m_stride, result.m_data, result.m_stride);
+        }
     }
 
-    double& operator()(unsigned int i, unsigned int j)
+    T& operator()(unsigned int i, unsigned int j)
     {
+#ifdef MATRIX_BOUNDS_CHECK
         if (i >= m_rows or j >= m_cols)
             throw std::runtime_error("Matrix::operator() out of bounds.");
-
-        return m_matrix[i][j];
+#endif
+        return unchecked(i, j);
     }
 
-    const double& operator()(unsigned int i, unsigned int j) const
+    const T& operator()(unsigned int i, unsigned int j) const
     {
+#ifdef MATRIX_BOUNDS_CHECK
         if (i >= m_rows or j >= m_cols)
             throw std::runtime_error("Matrix::operator() out of bounds.");
+#endif
+        return unchecked(i, j);
+    }
 
-        return m_matrix[i][j];
+    T& unchecked(unsigned int i, unsigned int j)
+    {
+        return m_data[static_cast<std::size_t>(i) * m_stride + j];
     }
 
-    Matrix operator*(Matrix& lhl)
+    const T& unchecked(unsigned int i, unsigned int j) const
     {
-        if (m_cols != lhl.size().first)
-            throw std::runtime_error("Matrix::operator*() Matrixes are not compatible.");
+        return m_data[static_cast<std::size_t>(i) * m_stride + j];
+    }
 
-        Matrix result(m_rows, lhl.size().second);
-        for (int i = 0; i < result.size().first; i++)
-        {
-            for (int j = 0; j < result.size().second; j++)
-            {
-                double sum = 0;
-                for(int k = 0; k < m_cols; k++)
-                {
-                    auto a = m_matrix[i][k];
-			        auto b = lhl(k, j); 
-                    sum += m_matrix[i][k] * lhl(k, j);
-                }
-                result(i, j) = sum;
-            }
-        }
+    T eval(unsigned int i, unsigned int j) const
+    {
+        return unchecked(i, j);
+    }
+
+    BasicMatrix operator*(const BasicMatrix& lhl) const
+    {
+        BasicMatrix result(0, 0);
+        multiply(*this, lhl, result);
 
         return result;
     }
 
-    Matrix operator*(double lhl)
+    BasicMatrix& operator=(const std::vector<T>& lhl)
     {
-        Matrix result(m_rows, m_cols);
-        for (int i = 0; i < result.size().first; i++)
-        {
-            for (int j = 0; j < result.size().second; j++)
-            {
-                result(i, j) = m_matrix[i][j] * lhl;
-            }
-        }
+        _reshape(lhl.size(), 1);
+        std::memcpy(m_data, lhl.data(), lhl.size() * sizeof(T));
 
-        return result;
+        return *this;
     }
 
-    Matrix operator=(const std::vector<double>& lhl)
+    BasicMatrix& operator=(const BasicMatrix& lhl)
     {
-        _resize(lhl.size(), 1);
-        
-        for (int i = 0; i < lhl.size(); i++)
+        if (this != &lhl)
         {
-            this->operator()(i, 0) = lhl.at(i);
+            _copy_from(lhl);
         }
 
         return *this;
     }
 
-    Matrix operator=(const Matrix& lhl)
+    BasicMatrix& operator=(BasicMatrix&& lhl) noexcept
+    {
+        _swap(lhl);
+
+        return *this;
+    }
+
+    template<typename E>
+    BasicMatrix& operator=(const MatrixExpr<E>& lhl)
+    {
+        const auto lhl_size = lhl.size();
+        // Elementwise expressions may read this matrix; that is only possible
+        // when the shapes match, and then the buffer is written in place.
+        if (lhl_size != size())
+            _reshape(lhl_size.first, lhl_size.second);
+
+        _assign(lhl.self());
+
+        return *this;
+    }
+
+    template<typename E>
+    BasicMatrix& operator+=(const MatrixExpr<E>& lhl)
     {
-        _resize(lhl.size().first, lhl.size().second);
-        
-        for (int i = 0; i < m_rows; i++)
+        if (lhl.size() != size())
+            throw std::runtime_error("Matrix::operator+=() Matrixes are not compatible.");
+
+        const auto& source = lhl.self();
+        for (unsigned int i = 0; i < m_rows; i++)
         {
-            for (int j = 0; j < m_cols; j++)
+            T* dst = row(i);
+            for (unsigned int j = 0; j < m_cols; j++)
             {
-                this->operator()(i, j) = lhl(i, j);
+                dst[j] += source.eval(i, j);
             }
         }
 
         return *this;
     }
 
-    Matrix operator+(const Matrix& lhl)
+    template<typename E>
+    BasicMatrix& operator-=(const MatrixExpr<E>& lhl)
     {
-        if (m_rows != lhl.size().first or m_cols != lhl.size().second)
-            throw std::runtime_error("Matrix::operator+() Matrixes are not compatible.");
+        if (lhl.size() != size())
+            throw std::runtime_error("Matrix::operator-=() Matrixes are not compatible.");
 
-        Matrix result(m_rows, m_cols);
-        for (int i = 0; i < result.size().first; i++)
+        const auto& source = lhl.self();
+        for (unsigned int i = 0; i < m_rows; i++)
         {
-            for (int j = 0; j < result.size().second; j++)
+            T* dst = row(i);
+            for (unsigned int j = 0; j < m_cols; j++)
             {
-                result(i, j) = this->operator()(i, j) + lhl(i, j);
+                dst[j] -= source.eval(i, j);
             }
         }
 
-        return result;
+        return *this;
     }
 
-    Matrix operator-(const Matrix& lhl)
+private:
+    // Sets the shape, reusing the buffer when it is big enough. Element values are
+    // left unspecified, only the row padding is cleared.
+    void _reshape(unsigned int rows, unsigned int cols)
     {
-        if (m_rows != lhl.size().first or m_cols != lhl.size().second)
-            throw std::runtime_error("Matrix::operator-() Matrixes are not compatible.");
+        const unsigned int stride = natural_stride(cols);
+        const std::size_t required = static_cast<std::size_t>(rows) * stride;
+
+        if (required > m_capacity)
+        {
+            if (m_owns_data)
+                std::free(m_data);
+            m_data = nullptr;
+            m_capacity = 0;
+
+            // aligned_alloc requires the size to be a multiple of the alignment.
+            const std::size_t bytes = (required * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            m_data = static_cast<T*>(std::aligned_alloc(ALIGNMENT, bytes));
+            if (m_data == nullptr)
+                throw std::bad_alloc();
+
+            m_capacity = bytes / sizeof(T);
+            m_owns_data = true;
+            detail::matrix_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
 
-        Matrix result(m_rows, m_cols);
-        for (int i = 0; i < result.size().first; i++)
+        m_rows = rows;
+        m_cols = cols;
+        m_stride = stride;
+
+        if (m_stride > m_cols)
         {
-            for (int j = 0; j < result.size().second; j++)
+            for (unsigned int i = 0; i < m_rows; i++)
             {
-                result(i, j) = this->operator()(i, j) - lhl(i, j);
+                T* r = row(i);
+                for (unsigned int j = m_cols; j < m_stride; j++)
+                {
+                    r[j] = 0;
+                }
             }
         }
-
-        return result;
     }
 
-    Matrix operator-(const std::vector<double>& lhl)
+    void _resize(unsigned int rows, unsigned int cols, T default_values = 0)
     {
-        if (m_cols != 1 or lhl.size() != m_rows)
-            throw std::runtime_error("Matrix::operator-() Matrixes are not compatible.");
+        _reshape(rows, cols);
 
-        Matrix result(m_rows, m_cols);
-        for (int i = 0; i < result.size().first; i++)
+        for (unsigned int i = 0; i < m_rows; i++)
         {
-            result(i, 0) = this->operator()(i, 0)- lhl.at(i);
+            T* r = row(i);
+            for (unsigned int j = 0; j < m_cols; j++)
+            {
+                r[j] = default_values;
+            }
         }
-
-        return result;
     }
 
-private:
-    void _resize(unsigned int rows, unsigned int cols, double default_values = 0)
+    template<typename E>
+    void _assign(const E& source)
     {
-        m_matrix.clear();
-
-        m_rows = rows;
-        m_cols = cols;
+        for (unsigned int i = 0; i < m_rows; i++)
+        {
+            T* dst = row(i);
+            for (unsigned int j = 0; j < m_cols; j++)
+            {
+                dst[j] = source.eval(i, j);
+            }
+        }
+    }
 
-        m_matrix.resize(m_rows);
-        for (int i = 0; i < m_rows; i++)
+    void _copy_from(const BasicMatrix& lhl)
+    {
+        _reshape(lhl.m_rows, lhl.m_cols);
+        // A view may have any stride, so rows are copied one at a time.
+        for (unsigned int i = 0; i < m_rows; i++)
         {
-            m_matrix[i].resize(m_cols, default_values);
+            std::memcpy(row(i), lhl.row(i), m_cols * sizeof(T));
         }
     }
 
-private: 
-    unsigned int m_rows;
-    unsigned int m_cols;
+    void _swap(BasicMatrix& lhl) noexcept
+    {
+        std::swap(m_rows, lhl.m_rows);
+        std::swap(m_cols, lhl.m_cols);
+        std::swap(m_stride, lhl.m_stride);
+        std::swap(m_capacity, lhl.m_capacity);
+        std::swap(m_data, lhl.m_data);
+        std::swap(m_owns_data, lhl.m_owns_data);
+    }
 
-    std::vector<std::vector<double>> m_matrix;
-};
\ No newline at end of file
+private:
+    unsigned int m_rows = 0;
+    unsigned int m_cols = 0;
+    unsigned int m_stride = 0;
+    std::size_t m_capacity = 0;
+
+    T* m_data = nullptr;
+    bool m_owns_data = true;
+};
+
+// Matrix stays double precision for general linear algebra and reference results,
+// the network itself runs on float (see NeuroNet.hpp).
+using Matrix = BasicMatrix<double>;
+using MatrixF = BasicMatrix<float>;
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+// Lazy elementwise Matrix arithmetic. Operators build a tree of lightweight
+// nodes; the whole tree is evaluated in a single loop when it is assigned to a
+// Matrix, so `a + b * 2` costs one pass over memory and no temporaries.
+// Expressions reference their Matrix operands, don't keep them (e.g. in `auto`)
+// beyond the statement that built them.
+
+template<typename T>
+class BasicMatrix;
+
+template<typename E>
+class MatrixExpr
+{
+public:
+    const E& self() const
+    {
+        return static_cast<const E&>(*this);
+    }
+
+    std::pair<unsigned int, unsigned int> size() const
+    {
+        return self().size();
+    }
+
+    auto eval(unsigned int i, unsigned int j) const
+    {
+        return self().eval(i, j);
+    }
+};
+
+namespace expr
+{
+    // Matrices are held by reference, intermediate nodes are small and held by value.
+    template<typename E>
+    struct Operand
+    {
+        using type = const E;
+    };
+
+    template<typename T>
+    struct Operand<BasicMatrix<T>>
+    {
+        using type = const BasicMatrix<T>&;
+    };
+
+    struct Add
+    {
+        template<typename T>
+        static T apply(T a, T b) { return a + b; }
+    };
+
+    struct Sub
+    {
+        template<typename T>
+        static T apply(T a, T b) { return a - b; }
+    };
+
+    struct Mul
+    {
+        template<typename T>
+        static T apply(T a, T b) { return a * b; }
+    };
+}
+
+template<typename L, typename R, typename Op>
+class MatrixBinaryExpr : public MatrixExpr<MatrixBinaryExpr<L, R, Op>>
+{
+public:
+    using value_type = typename L::value_type;
+
+    MatrixBinaryExpr(const L& lhs, const R& rhs, const char* op_name)
+        : m_lhs(lhs)
+        , m_rhs(rhs)
+    {
+        if (m_lhs.size() != m_rhs.size())
+            throw std::runtime_error(std::string("Matrix::") + op_name + "() Matrixes are not compatible.");
+    }
+
+    std::pair<unsigned int, unsigned int> size() const
+    {
+        return m_lhs.size();
+    }
+
+    value_type eval(unsigned int i, unsigned int j) const
+    {
+        return Op::apply(m_lhs.eval(i, j), static_cast<value_type>(m_rhs.eval(i, j)));
+    }
+
+private:
+    typename expr::Operand<L>::type m_lhs;
+    typename expr::Operand<R>::type m_rhs;
+};
+
+template<typename E, typename Op>
+class MatrixScalarExpr : public MatrixExpr<MatrixScalarExpr<E, Op>>
+{
+public:
+    using value_type = typename E::value_type;
+
+    MatrixScalarExpr(const E& lhs, value_type rhs)
+        : m_lhs(lhs)
+        , m_rhs(rhs)
+    {}
+
+    std::pair<unsigned int, unsigned int> size() const
+    {
+        return m_lhs.size();
+    }
+
+    value_type eval(unsigned int i, unsigned int j) const
+    {
+        return Op::apply(m_lhs.eval(i, j), m_rhs);
+    }
+
+private:
+    typename expr::Operand<E>::type m_lhs;
+    value_type m_rhs;
+};
+
+// A std::vector seen as a single column matrix.
+template<typename T>
+class ColumnVectorExpr : public MatrixExpr<ColumnVectorExpr<T>>
+{
+public:
+    using value_type = T;
+
+    ColumnVectorExpr(const std::vector<T>& values)
+        : m_values(values)
+    {}
+
+    std::pair<unsigned int, unsigned int> size() const
+    {
+        return {static_cast<unsigned int>(m_values.size()), 1};
+    }
+
+    T eval(unsigned int i, unsigned int) const
+    {
+        return m_values[i];
+    }
+
+private:
+    const std::vector<T>& m_values;
+};
+
+template<typename L, typename R>
+MatrixBinaryExpr<L, R, expr::Add> operator+(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs)
+{
+    return {lhs.self(), rhs.self(), "operator+"};
+}
+
+template<typename L, typename R>
+MatrixBinaryExpr<L, R, expr::Sub> operator-(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs)
+{
+    return {lhs.self(), rhs.self(), "operator-"};
+}
+
+template<typename L, typename T>
+MatrixBinaryExpr<L, ColumnVectorExpr<T>, expr::Sub> operator-(const MatrixExpr<L>& lhs, const std::vector<T>& rhs)
+{
+    return {lhs.self(), ColumnVectorExpr<T>(rhs), "operator-"};
+}
+
+template<typename E>
+MatrixScalarExpr<E, expr::Mul> operator*(const MatrixExpr<E>& lhs, typename E::value_type rhs)
+{
+    return {lhs.self(), rhs};
+}
+
+template<typename E>
+MatrixScalarExpr<E, expr::Mul> operator*(typename E::value_type lhs, const MatrixExpr<E>& rhs)
+{
+    return {rhs.self(), lhs};
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "NeuroNet.hpp"
+#include "SampleView.hpp"
+
+struct BatchingOptions
+{
+    // A batch is run as soon as it holds max_batch requests, or once its oldest
+    // request has waited max_delay.
+    unsigned int max_batch = 64;
+    std::chrono::microseconds max_delay {500};
+    // Threads running batches, each with its own workspace on the shared network.
+    unsigned int threads = 1;
+};
+
+// Counters of a MicroBatcher since it started. Latency is from submit() until the
+// answer is ready, queueing included.
+struct ServingStats
+{
+    std::uint64_t requests;
+    std::uint64_t batches;
+    double mean_batch;
+    double p50_seconds;
+    double p99_seconds;
+    double requests_per_second;
+    double uptime_seconds;
+};
+
+// Gathers single requests submitted from any number of threads into batches for
+// NeuroNet::analyze_batch(). A lone request waits at most max_delay for company,
+// under load the batches fill up and every weight load serves max_batch samples.
+// The network is only read, it must outlive the batcher and not be trained meanwhile.
+class MicroBatcher
+{
+public:
+    MicroBatcher(const NeuroNet& net, BatchingOptions options = {})
+        : m_net(net)
+        , m_options(options)
+        , m_start(Clock::now())
+    {
+        if (m_options.max_batch == 0 or m_options.threads == 0)
+            throw std::runtime_error("MicroBatcher::MicroBatcher() max_batch and threads must be positive.");
+
+        for (unsigned int i = 0; i < m_options.threads; i++)
+        {
+            m_workers.emplace_back(&MicroBatcher::_work, this);
+        }
+    }
+
+    MicroBatcher(const MicroBatcher&) = delete;
+    MicroBatcher& operator=(const MicroBatcher&) = delete;
+
+    // Requests still queued are answered with an exception.
+    ~MicroBatcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+        for (auto& request : m_queue)
+        {
+            request.answer.set_exception(std::make_exception_ptr(std::runtime_error("MicroBatcher stopped.")));
+        }
+    }
+
+    unsigned int input_size() const
+    {
+        return m_net.layers_sizes().front();
+    }
+
+    const BatchingOptions& options() const
+    {
+        return m_options;
+    }
+
+    // Queues one sample of input_size() uint8 pixels, the future gets its answer.
+    std::future<int> submit(std::vector<std::uint8_t> pixels)
+    {
+        if (pixels.size() != input_size())
+            throw std::runtime_error("MicroBatcher::submit() request has " + std::to_string(pixels.size()) + " pixels instead of " + std::to_string(input_size()) + ".");
+
+        Request request {std::move(pixels), std::promise<int>(), Clock::now()};
+        auto answer = request.answer.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(request));
+        }
+        m_wake.notify_one();
+        return answer;
+    }
+
+    ServingStats stats() const
+    {
+        ServingStats result {};
+        result.requests = m_requests.load(std::memory_order_relaxed);
+        result.batches = m_batches.load(std::memory_order_relaxed);
+        result.mean_batch = result.batches ? static_cast<double>(result.requests) / result.batches : 0;
+        result.p50_seconds = m_latency.percentile(0.5);
+        result.p99_seconds = m_latency.percentile(0.99);
+        result.uptime_seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+        result.requests_per_second = result.uptime_seconds > 0 ? result.requests / result.uptime_seconds : 0;
+        return result;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::vector<std::uint8_t> pixels;
+        std::promise<int> answer;
+        Clock::time_point arrival;
+    };
+
+    void _work()
+    {
+        NeuroNet::AnalyzeWorkspace workspace;
+        std::vector<Request> batch;
+        std::vector<SampleView> inputs;
+        std::vector<int> answers;
+
+        while (_next_batch(batch))
+        {
+            inputs.clear();
+            for (const auto& request : batch)
+            {
+                inputs.emplace_back(request.pixels.data(), request.pixels.size(), PixelType::UInt8);
+            }
+            answers.resize(batch.size());
+
+            try
+            {
+                m_net.analyze_batch(inputs.data(), inputs.size(), answers.data(), nullptr, workspace);
+            }
+            catch (...)
+            {
+                for (auto& request : batch)
+                {
+                    request.answer.set_exception(std::current_exception());
+                }
+                continue;
+            }
+
+            // Counted before answering, so a client that got its answer sees it in stats().
+            const auto done = Clock::now();
+            for (const auto& request : batch)
+            {
+                m_latency.record(std::chrono::duration<double>(done - request.arrival).count());
+            }
+            m_requests.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < batch.size(); i++)
+            {
+                batch[i].answer.set_value(answers[i]);
+            }
+        }
+    }
+
+    // Waits for a full batch or for the oldest request to run out of delay, and
+    // moves up to max_batch requests into batch. Returns false once stopped.
+    bool _next_batch(std::vector<Request>& batch)
+    {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            if (m_stop)
+                return false;
+
+            if (m_queue.empty())
+            {
+                m_wake.wait(lock);
+                continue;
+            }
+            if (m_queue.size() >= m_options.max_batch)
+                break;
+
+            const auto deadline = m_queue.front().arrival + m_options.max_delay;
+            if (Clock::now() >= deadline)
+                break;
+            m_wake.wait_until(lock, deadline);
+        }
+
+        const std::size_t count = std::min<std::size_t>(m_queue.size(), m_options.max_batch);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            batch.push_back(std::move(m_queue.front()));
+            m_queue.pop_front();
+        }
+
+        // Leftovers may already make another batch for an idle worker.
+        if (not m_queue.empty())
+            m_wake.notify_one();
+        return true;
+    }
+
+    const NeuroNet& m_net;
+    const BatchingOptions m_options;
+    const Clock::time_point m_start;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Request> m_queue;
+    bool m_stop = false;
+
+    LatencyHistogram m_latency;
+    std::atomic<std::uint64_t> m_requests {0};
+    std::atomic<std::uint64_t> m_batches {0};
+
+    std::vector<std::thread> m_workers;
+};
@@ -4,15 +4,24 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <iostream>
+#include <limits>
+#include <algorithm>
 
 #include "IActivatorFunc.hpp"
 #include "Matrix.hpp"
+#include "SampleView.hpp"
+#include "TextParser.hpp"
+#include "WeightsFile.hpp"
+#include "kernels/Dense.hpp"
 
-
-class NeuroNet
+template<typename T>
+class BasicNeuroNet
 {
 public:
-    NeuroNet(const std::vector<unsigned int>& layers_sizes, std::weak_ptr<IActivatorFunc> activator_func)
+    using value_type = T;
+
+    BasicNeuroNet(const std::vector<unsigned int>& layers_sizes, std::weak_ptr<BasicActivatorFunc<T>> activator_func)
         : m_activator(activator_func)
         , m_layers_sizes(layers_sizes)
     {
@@ -30,7 +39,25 @@ public:
         }
     }
 
-    double analyze(const std::vector<double>& input)
+    // Per-sample state of analyze() and back_propagate(): the activations and sigmas
+    // of every layer. The network keeps one for the plain overloads; threads sharing
+    // a network pass their own (see HogwildTrainer.hpp).
+    struct SampleWorkspace
+    {
+        std::vector<BasicMatrix<T>> neurons;
+        std::vector<BasicMatrix<T>> sigmas;
+    };
+
+    // Accepts std::vector samples of any arithmetic type and SampleView, they are
+    // converted into the input layer by copy_sample().
+    template<typename Sample>
+    double analyze(const Sample& input)
+    {
+        return analyze(input, m_sample);
+    }
+
+    template<typename Sample>
+    double analyze(const Sample& input, SampleWorkspace& workspace) const
     {
         if (input.size() != m_layers_sizes.at(0))
             throw std::runtime_error("Input data size doesn't match the actual input layer size (" + std::to_string(input.size()) + " != " + std::to_string(m_layers_sizes.at(0)) + ").");
@@ -39,73 +66,337 @@ public:
         if (not activator)
             throw std::runtime_error("Activator func is nulptr.");
 
-        m_neurons_layers[0] = input;
+        _reserve_sample(workspace);
+        auto& neurons_layers = workspace.neurons;
+
+        copy_sample(input, neurons_layers[0].data());
+
+        const auto activate = [&activator](T* values, unsigned int count) {
+            activator->func_inplace(values, count);
+        };
 
         for(int layer = 0; layer < m_layers_sizes.size() - 1; ++layer)
         {
-            m_neurons_layers[layer + 1] = m_weights[layer] * m_neurons_layers[layer];
-            m_neurons_layers[layer + 1] = m_neurons_layers[layer + 1] + m_bioses[layer];
-
-            m_neurons_layers[layer + 1] = activator->func(m_neurons_layers[layer + 1]);
+            const auto& weights = m_weights[layer];
+            kernels::dense_forward(weights.size().first, weights.size().second, weights.data(), weights.stride(),
+                neurons_layers[layer].data(), m_bioses[layer].data(), neurons_layers[layer + 1].data(), activate);
         }
 
         const auto outputLayerNum = m_layers_sizes.size() - 1;
-        double max = -__DBL_MAX__;
+        T max = -std::numeric_limits<T>::max();
         int max_answer = -1;
-        for (int i = 0; i < m_neurons_layers.at(outputLayerNum).size().first; i++)
+        for (int i = 0; i < neurons_layers.at(outputLayerNum).size().first; i++)
         {
-            if (m_neurons_layers.at(outputLayerNum)(i, 0) > max)
+            if (neurons_layers.at(outputLayerNum)(i, 0) > max)
             {
-                max = m_neurons_layers.at(outputLayerNum)(i, 0);
+                max = neurons_layers.at(outputLayerNum)(i, 0);
                 max_answer = i;
             } 
         }
         return max_answer;
     }
 
+    const std::vector<unsigned int>& layers_sizes() const
+    {
+        return m_layers_sizes;
+    }
+
+    const std::vector<BasicMatrix<T>>& weights() const
+    {
+        return m_weights;
+    }
+
+    const std::vector<BasicMatrix<T>>& bioses() const
+    {
+        return m_bioses;
+    }
+
     void back_propagate(int reference, double study_coef = 1)
+    {
+        back_propagate(reference, study_coef, m_sample);
+    }
+
+    // Backpropagates the sample last analyzed with workspace and updates the weights
+    // in place. Several threads may do this at once on their own workspaces: they
+    // then race on the weights without locks (Hogwild!), an update may be lost or
+    // read half-applied but every float is read and written whole.
+    void back_propagate(int reference, double study_coef, SampleWorkspace& workspace)
     {
         const auto activator = m_activator.lock();
         if (not activator)
             throw std::runtime_error("Activator func is nulptr.");
 
+        auto& neurons_layers = workspace.neurons;
+        auto& sigmas = workspace.sigmas;
+        if (neurons_layers.size() != m_layers_sizes.size())
+            throw std::runtime_error("NeuroNet::back_propagate() the workspace holds no analyzed sample.");
+
+        // The derivatives come from the activations analyze() left, so this pass
+        // does no transcendental math.
         const int outputLayerNum = m_layers_sizes.size() - 1;
         for (int i = 0; i < m_layers_sizes.at(outputLayerNum); i++)
         {
-            double d = i == reference ? 1 : 0;
-            m_sigmas.at(outputLayerNum)(i, 0) = (d - m_neurons_layers.at(outputLayerNum)(i, 0)) * activator->derivative_func(m_neurons_layers.at(outputLayerNum)(i,0));
+            T d = i == reference ? 1 : 0;
+            sigmas.at(outputLayerNum)(i, 0) = d - neurons_layers.at(outputLayerNum)(i, 0);
         }
+        activator->backward_inplace(neurons_layers[outputLayerNum].data(), sigmas[outputLayerNum].data(), m_layers_sizes[outputLayerNum]);
 
         for (int layer = outputLayerNum - 1; layer > 0; layer--)
         {         
-            auto transponated = Matrix::transponate(m_weights.at(layer));
-            m_sigmas[layer] = transponated * m_sigmas[layer + 1];
+            const auto& weights = m_weights.at(layer);
+            kernels::gemv_t(weights.size().first, weights.size().second, weights.data(), weights.stride(),
+                sigmas[layer + 1].data(), sigmas[layer].data());
 
-            for(auto i = 0; i < m_layers_sizes.at(layer); i++)
-            {
-                m_sigmas[layer](i, 0) *= activator->derivative_func(m_neurons_layers.at(layer)(i, 0));
-            }
+            activator->backward_inplace(neurons_layers[layer].data(), sigmas[layer].data(), m_layers_sizes[layer]);
         }
 
         for (int layer = 0; layer < outputLayerNum; layer++)
-        {            
-            for (int i = 0; i < m_weights.at(layer).size().first; i++)
+        {
+            auto& weights = m_weights[layer];
+            kernels::rank1_update(weights.size().first, weights.size().second, weights.data(), weights.stride(), static_cast<T>(study_coef),
+                sigmas[layer + 1].data(), neurons_layers[layer].data(), m_bioses[layer].data());
+        }
+
+        // check_for_nan();
+    }
+    
+    // Samples analyze_batch() pushes through the layers at once. Every weight loaded
+    // serves the whole tile, while the tile's activations stay in L2.
+    static constexpr unsigned int ANALYZE_TILE = 64;
+    // A GEMM tile costs a whole vector of columns however few samples it holds, about
+    // as much as three quarters of a vector of GEMVs; shorter tiles go through analyze().
+    static constexpr unsigned int ANALYZE_MIN_TILE = BasicMatrix<T>::ALIGNMENT / sizeof(T) * 3 / 4;
+
+    // Buffers of analyze_batch(): a tile of inputs as rows and the layer_size x tile
+    // activations, and the workspace of the short tiles. A workspace belongs to one thread.
+    struct AnalyzeWorkspace
+    {
+        BasicMatrix<T> input_rows = BasicMatrix<T>(0, 0);
+        std::vector<BasicMatrix<T>> neurons;
+        SampleWorkspace sample;
+    };
+
+    // The answers analyze() would give for every input, computed ANALYZE_TILE samples
+    // at a time with GEMMs instead of one GEMV per sample. With scores, the output
+    // layer of every sample is left in its row. A scores matrix with at least as
+    // many rows is reused as it is, rows past the samples are left untouched.
+    template<typename Sample>
+    std::vector<int> analyze_batch(const std::vector<Sample>& inputs, BasicMatrix<T>* scores = nullptr)
+    {
+        std::vector<int> answers(inputs.size());
+        analyze_batch(inputs.data(), inputs.size(), answers.data(), scores, m_analyze);
+        return answers;
+    }
+
+    // Writes count answers for the count samples of inputs. The network is only read,
+    // so threads may run this concurrently on their own workspaces.
+    template<typename Sample>
+    void analyze_batch(const Sample* inputs, unsigned int count, int* answers, BasicMatrix<T>* scores, AnalyzeWorkspace& workspace) const
+    {
+        const auto activator = m_activator.lock();
+        if (not activator)
+            throw std::runtime_error("Activator func is nulptr.");
+
+        const unsigned int outputLayerNum = m_layers_sizes.size() - 1;
+        const unsigned int outputs = m_layers_sizes[outputLayerNum];
+        if (scores and (scores->size().first < count or scores->size().second != outputs))
+            *scores = BasicMatrix<T>(count, outputs);
+        _reserve_analyze(workspace);
+
+        // A short tile runs on whole vectors too; the columns past count hold the
+        // previous tile's samples and are never read back.
+        constexpr unsigned int lanes = BasicMatrix<T>::ALIGNMENT / sizeof(T);
+        for (unsigned int first = 0; first < count; first += ANALYZE_TILE)
+        {
+            const unsigned int tile = std::min(count - first, ANALYZE_TILE);
+            if (tile < ANALYZE_MIN_TILE)
+            {
+                for (unsigned int b = first; b < count; b++)
+                {
+                    answers[b] = analyze(inputs[b], workspace.sample);
+                    if (scores)
+                    {
+                        for (unsigned int i = 0; i < outputs; i++)
+                        {
+                            scores->unchecked(b, i) = workspace.sample.neurons[outputLayerNum](i, 0);
+                        }
+                    }
+                }
+                break;
+            }
+
+            const unsigned int columns = std::min((tile + lanes - 1) / lanes * lanes, ANALYZE_TILE);
+            _forward_batch(inputs + first, tile, columns, workspace.input_rows, workspace.neurons, *activator);
+
+            const auto& output = workspace.neurons[outputLayerNum];
+            for (unsigned int b = 0; b < tile; b++)
+            {
+                answers[first + b] = _answer(output, b);
+            }
+            if (scores)
             {
-                for (int j = 0; j < m_weights.at(layer).size().second; j++)
+                for (unsigned int i = 0; i < outputs; i++)
                 {
-                    m_weights[layer](i, j) += m_neurons_layers.at(layer)(j, 0) * m_sigmas[layer + 1](i, 0) * study_coef;
+                    const T* row = output.row(i);
+                    for (unsigned int b = 0; b < tile; b++)
+                    {
+                        scores->unchecked(first + b, i) = row[b];
+                    }
                 }
             }
+        }
+    }
 
-            m_bioses[layer] = m_bioses[layer] + m_sigmas[layer + 1] * study_coef;
+    // Buffers of one mini-batch pass: layer_size x batch activations and sigmas,
+    // batch x layer_size transposed activations, and the gradients summed over the
+    // batch. A workspace belongs to one thread; sized by compute_gradients().
+    struct BatchWorkspace
+    {
+        // Samples of the last pass; the buffers are shaped for batch_size of them.
+        unsigned int samples = 0;
+        unsigned int batch_size = 0;
+        std::vector<BasicMatrix<T>> neurons;
+        std::vector<BasicMatrix<T>> sigmas;
+        std::vector<BasicMatrix<T>> transposed;
+        std::vector<BasicMatrix<T>> gradients;
+        std::vector<BasicMatrix<T>> bios_gradients;
+    };
+
+    // One step of mini-batch gradient descent over inputs.size() samples. The samples
+    // are stacked as the columns of a layer_size x batch matrix, so the forward and
+    // backward passes run as GEMMs instead of one GEMV per sample. Gradients are
+    // summed over the batch, i.e. study_coef keeps its per-sample meaning and a batch
+    // of one is the same step as analyze() followed by back_propagate().
+    // Returns how many samples the network answered right before the update.
+    template<typename Sample>
+    int train_batch(const std::vector<int>& labels, const std::vector<Sample>& inputs, double study_coef = 1)
+    {
+        if (labels.size() != inputs.size())
+            throw std::runtime_error("NeuroNet::train_batch() labels and inputs counts differ (" + std::to_string(labels.size()) + " != " + std::to_string(inputs.size()) + ").");
+        if (inputs.empty())
+            return 0;
+
+        const int good = compute_gradients(labels.data(), inputs.data(), inputs.size(), m_batch);
+        apply_gradients({&m_batch}, study_coef);
+        return good;
+    }
+
+    // Forward and backward pass over count samples, leaving the summed gradients in
+    // workspace. The network itself is only read, so threads may run this concurrently
+    // on their own workspaces. Returns how many samples were answered right.
+    template<typename Sample>
+    int compute_gradients(const int* labels, const Sample* inputs, unsigned int count, BatchWorkspace& workspace) const
+    {
+        const auto activator = m_activator.lock();
+        if (not activator)
+            throw std::runtime_error("Activator func is nulptr.");
+
+        const unsigned int outputLayerNum = m_layers_sizes.size() - 1;
+        workspace.samples = count;
+        if (count == 0)
+            return 0;
+        _reserve_batch(workspace, count);
+
+        // Samples arrive as rows, which is the layout the weight gradient wants.
+        // Batch matrices are row padded with zeros. Multiplying the padding columns as
+        // well keeps the GEMMs on whole vectors for any batch size and leaves them zero.
+        const unsigned int padded_batch = workspace.neurons[0].stride();
+        _forward_batch(inputs, count, padded_batch, workspace.transposed[0], workspace.neurons, *activator);
+
+        int good = 0;
+        const auto& output = workspace.neurons[outputLayerNum];
+        for (unsigned int b = 0; b < count; b++)
+        {
+            good += _answer(output, b) == labels[b];
         }
 
-        // check_for_nan();
+        auto& output_sigmas = workspace.sigmas[outputLayerNum];
+        for (unsigned int i = 0; i < m_layers_sizes[outputLayerNum]; i++)
+        {
+            const T* y = output.row(i);
+            T* sigma = output_sigmas.row(i);
+            for (unsigned int b = 0; b < count; b++)
+            {
+                const T d = static_cast<int>(i) == labels[b] ? 1 : 0;
+                sigma[b] = d - y[b];
+            }
+            activator->backward_inplace(y, sigma, count);
+        }
+
+        for (unsigned int layer = outputLayerNum - 1; layer > 0; layer--)
+        {
+            const auto& weights = m_weights[layer];
+            auto& sigmas = workspace.sigmas[layer];
+            kernels::gemm_tn(weights.size().second, padded_batch, weights.size().first, weights.data(), weights.stride(),
+                workspace.sigmas[layer + 1].data(), workspace.sigmas[layer + 1].stride(), sigmas.data(), sigmas.stride());
+
+            for (unsigned int i = 0; i < m_layers_sizes[layer]; i++)
+            {
+                activator->backward_inplace(workspace.neurons[layer].row(i), sigmas.row(i), count);
+            }
+        }
+
+        for (unsigned int layer = 0; layer < outputLayerNum; layer++)
+        {
+            if (layer > 0)
+                BasicMatrix<T>::transponate(workspace.neurons[layer], workspace.transposed[layer]);
+
+            const auto& sigmas = workspace.sigmas[layer + 1];
+            auto& gradient = workspace.gradients[layer];
+            kernels::gemm(gradient.size().first, gradient.size().second, count, sigmas.data(), sigmas.stride(),
+                workspace.transposed[layer].data(), workspace.transposed[layer].stride(), gradient.data(), gradient.stride());
+
+            for (unsigned int i = 0; i < m_layers_sizes[layer + 1]; i++)
+            {
+                const T* sigma = sigmas.row(i);
+                T sum = 0;
+                for (unsigned int b = 0; b < count; b++)
+                {
+                    sum += sigma[b];
+                }
+                workspace.bios_gradients[layer](i, 0) = sum;
+            }
+        }
+
+        return good;
     }
-    
+
+    // Adds study_coef times the sum of the workspaces' gradients to the weights and biases.
+    // The rows of every layer are split into parts; calls for different parts touch
+    // disjoint rows and may run concurrently. Workspaces are summed in the given order.
+    void apply_gradients(const std::vector<const BatchWorkspace*>& workspaces, double study_coef, unsigned int part = 0, unsigned int parts = 1)
+    {
+        const T coef = static_cast<T>(study_coef);
+        for (unsigned int layer = 0; layer < m_weights.size(); layer++)
+        {
+            auto& weights = m_weights[layer];
+            const unsigned int rows = weights.size().first;
+            const unsigned int cols = weights.size().second;
+            const unsigned int first = static_cast<unsigned long>(rows) * part / parts;
+            const unsigned int last = static_cast<unsigned long>(rows) * (part + 1) / parts;
+
+            for (unsigned int i = first; i < last; i++)
+            {
+                T* row = weights.row(i);
+                for (const auto* workspace : workspaces)
+                {
+                    if (workspace->samples == 0)
+                        continue;
+
+                    const T* gradient = workspace->gradients[layer].row(i);
+                    for (unsigned int j = 0; j < cols; j++)
+                    {
+                        row[j] += coef * gradient[j];
+                    }
+                    m_bioses[layer](i, 0) += coef * workspace->bios_gradients[layer](i, 0);
+                }
+            }
+        }
+    }
+
     void check_for_nan()
     {
-        for(auto layer : m_neurons_layers)
+        for(const auto& layer : m_sample.neurons)
         {
             auto size = layer.size();
             for (int i = 0; i < size.first; i++)
@@ -120,7 +411,7 @@ public:
             }
         }
 
-        for(auto layer : m_weights)
+        for(const auto& layer : m_weights)
         {
             auto size = layer.size();
             for (int i = 0; i < size.first; i++)
@@ -136,23 +427,33 @@ public:
         }
     }
 
+    // Reads the text format or the binary one (see WeightsFile.hpp). Binary weights
+    // of the network's own precision aren't copied: the matrices view the mapped file.
     void read_weights(const std::string& filename)
     {
-        std::ifstream input(filename);
-        if (not input)
+        if (is_weights_file(filename))
         {
-            throw std::runtime_error("Couldn't find file \"" + filename + "\".");
+            _read_binary_weights(filename);
+            return;
         }
 
-        int layers_count;
-        input >> layers_count;
+        const MappedFile file(filename);
+        const char* text = reinterpret_cast<const char*>(file.data());
+        const auto values = parse_numbers<T>(text, text + file.size());
+
+        std::size_t position = 0;
+        const auto next = [&]() {
+            if (position == values.size())
+                throw std::runtime_error("Truncated weights file \"" + filename + "\".");
+            return values[position++];
+        };
+
+        const int layers_count = next();
         m_layers_sizes.clear();
 
         for (int i = 0; i < layers_count; i++)
         {
-            double temp;
-            input >> temp;
-            m_layers_sizes.push_back(temp);
+            m_layers_sizes.push_back(next());
         }
         
         _rebuild();
@@ -165,9 +466,7 @@ public:
             {
                 for (int j = 0; j < size.second; j++)
                 {
-                    double temp = 0;
-                    input >> temp;
-                    layer(i, j) = temp;
+                    layer(i, j) = next();
                     count++;
                 }
             }
@@ -180,12 +479,11 @@ public:
             {
                 for (int j = 0; j < size.second; j++)
                 {
-                    input >> bios(i, j);
+                    bios(i, j) = next();
                     count++;
                 }
             }
         }
-        
         std::cout << "Weights were read successfully. Total weights count: " << count << std::endl;
     }
 
@@ -197,6 +495,8 @@ public:
             throw std::runtime_error("Couldn't open file \"" + filename + "\".");
         }
 
+        // Enough digits for every value to read back bit for bit.
+        output.precision(std::numeric_limits<T>::max_digits10);
         output << m_layers_sizes.size() << " ";
 
         for (auto layer_size : m_layers_sizes)
@@ -233,35 +533,241 @@ public:
         
         std::cout << "Weights were wroten successfully." << std::endl;
     }
+
+    void save_weights_binary(const std::string& filename) const
+    {
+        write_weights_file(filename, m_layers_sizes, m_weights, m_bioses);
+        std::cout << "Weights were wroten successfully." << std::endl;
+    }
  
 private:
+    void _read_binary_weights(const std::string& filename)
+    {
+        auto file = std::make_shared<WeightsFile>(filename);
+        m_layers_sizes = file->layers_sizes();
+        int count = 0;
+
+        if (file->dtype() == weights_dtype_of<T>())
+        {
+            m_weights.clear();
+            m_bioses.clear();
+            for (unsigned int i = 0; i < file->sections_count(); i++)
+            {
+                const auto& section = file->section(i);
+                auto& matrices = i % 2 == 0 ? m_weights : m_bioses;
+                matrices.push_back(BasicMatrix<T>::view(file->template section_data<T>(i), section.rows, section.cols, section.stride));
+                count += section.rows * section.cols;
+            }
+            _reset_workspaces();
+            m_mapping = std::move(file);
+        }
+        else if (file->dtype() == WeightsDType::Float32)
+        {
+            count = _convert_weights<float>(*file);
+        }
+        else
+        {
+            count = _convert_weights<double>(*file);
+        }
+
+        std::cout << "Weights were read successfully. Total weights count: " << count << std::endl;
+    }
+
+    template<typename U>
+    int _convert_weights(WeightsFile& file)
+    {
+        _rebuild();
+        int count = 0;
+        for (unsigned int i = 0; i < file.sections_count(); i++)
+        {
+            const auto& section = file.section(i);
+            const U* values = file.template section_data<U>(i);
+            auto& matrix = i % 2 == 0 ? m_weights[i / 2] : m_bioses[i / 2];
+            for (unsigned int r = 0; r < section.rows; r++)
+            {
+                for (unsigned int c = 0; c < section.cols; c++)
+                {
+                    matrix(r, c) = static_cast<T>(values[static_cast<std::size_t>(r) * section.stride + c]);
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
 
-    void _rebuild(double default_weights = 0.5)
+    void _rebuild(T default_weights = 0.5)
     {
-        m_neurons_layers.clear();
-        m_sigmas.clear();
         m_weights.clear();
         m_bioses.clear();
 
         for (int i = 0; i < m_layers_sizes.size(); i++)
         {
-            m_neurons_layers.push_back(Matrix(m_layers_sizes.at(i), 1));
-            m_sigmas.push_back(Matrix(m_layers_sizes.at(i), 1));
-
             if (i < m_layers_sizes.size() - 1)
             {
                 // m_sum_layers.push_back(Matrix(m_layers_sizes.at(i + 1), 1));
-                m_weights.push_back(Matrix(m_layers_sizes.at(i + 1), m_layers_sizes.at(i), default_weights));
-                m_bioses.push_back(Matrix(m_layers_sizes.at(i + 1), 1, default_weights));
+                m_weights.push_back(BasicMatrix<T>(m_layers_sizes.at(i + 1), m_layers_sizes.at(i), default_weights));
+                m_bioses.push_back(BasicMatrix<T>(m_layers_sizes.at(i + 1), 1, default_weights));
+            }
+        }
+
+        m_mapping.reset();
+        _reset_workspaces();
+    }
+
+    void _reset_workspaces()
+    {
+        m_sample = SampleWorkspace();
+        _reserve_sample(m_sample);
+        m_batch = BatchWorkspace();
+        m_analyze = AnalyzeWorkspace();
+    }
+
+    // Sizes the workspace for the current topology, allocating only when it changed.
+    void _reserve_sample(SampleWorkspace& workspace) const
+    {
+        bool fits = workspace.neurons.size() == m_layers_sizes.size();
+        for (unsigned int i = 0; fits and i < m_layers_sizes.size(); i++)
+        {
+            fits = workspace.neurons[i].size().first == m_layers_sizes[i];
+        }
+        if (fits)
+            return;
+
+        workspace = SampleWorkspace();
+        for (int i = 0; i < m_layers_sizes.size(); i++)
+        {
+            workspace.neurons.push_back(BasicMatrix<T>(m_layers_sizes.at(i), 1));
+            workspace.sigmas.push_back(BasicMatrix<T>(m_layers_sizes.at(i), 1));
+        }
+    }
+
+    // Sizes the workspace, its buffers are only reallocated when the batch size changes.
+    void _reserve_batch(BatchWorkspace& workspace, unsigned int batch) const
+    {
+        bool fits = workspace.neurons.size() == m_layers_sizes.size();
+        for (unsigned int i = 0; fits and i < m_layers_sizes.size(); i++)
+        {
+            fits = workspace.neurons[i].size().first == m_layers_sizes[i];
+        }
+
+        if (fits)
+        {
+            if (batch == workspace.batch_size)
+                return;
+
+            // Another batch size only reshapes, the buffers keep the room of the largest batch so far.
+            for (unsigned int i = 0; i < m_layers_sizes.size(); i++)
+            {
+                workspace.neurons[i].reshape(m_layers_sizes[i], batch);
+                workspace.sigmas[i].reshape(m_layers_sizes[i], batch);
+                if (i < m_layers_sizes.size() - 1)
+                    workspace.transposed[i].reshape(batch, m_layers_sizes[i]);
+            }
+            workspace.batch_size = batch;
+            return;
+        }
+
+        const unsigned int samples = workspace.samples;
+        workspace = BatchWorkspace();
+        workspace.samples = samples;
+        for (int i = 0; i < m_layers_sizes.size(); i++)
+        {
+            workspace.neurons.push_back(BasicMatrix<T>(m_layers_sizes.at(i), batch));
+            workspace.sigmas.push_back(BasicMatrix<T>(m_layers_sizes.at(i), batch));
+
+            if (i < m_layers_sizes.size() - 1)
+            {
+                workspace.transposed.push_back(BasicMatrix<T>(batch, m_layers_sizes.at(i)));
+                workspace.gradients.push_back(BasicMatrix<T>(m_layers_sizes.at(i + 1), m_layers_sizes.at(i)));
+                workspace.bios_gradients.push_back(BasicMatrix<T>(m_layers_sizes.at(i + 1), 1));
+            }
+        }
+        workspace.batch_size = batch;
+    }
+
+    void _reserve_analyze(AnalyzeWorkspace& workspace) const
+    {
+        bool fits = workspace.neurons.size() == m_layers_sizes.size();
+        for (unsigned int i = 0; fits and i < m_layers_sizes.size(); i++)
+        {
+            fits = workspace.neurons[i].size().first == m_layers_sizes[i];
+        }
+        if (fits)
+            return;
+
+        workspace = AnalyzeWorkspace();
+        workspace.input_rows = BasicMatrix<T>(ANALYZE_TILE, m_layers_sizes.at(0));
+        for (int i = 0; i < m_layers_sizes.size(); i++)
+        {
+            workspace.neurons.push_back(BasicMatrix<T>(m_layers_sizes.at(i), ANALYZE_TILE));
+        }
+    }
+
+    // Forward pass of count samples: they are copied into the rows of input_rows and
+    // transposed into the columns of neurons[0], then every layer is one GEMM over
+    // the first columns columns (count or more) of neurons.
+    template<typename Sample>
+    void _forward_batch(const Sample* inputs, unsigned int count, unsigned int columns, BasicMatrix<T>& input_rows,
+        std::vector<BasicMatrix<T>>& neurons, BasicActivatorFunc<T>& activator) const
+    {
+        for (unsigned int b = 0; b < count; b++)
+        {
+            if (inputs[b].size() != m_layers_sizes.at(0))
+                throw std::runtime_error("Input data size doesn't match the actual input layer size (" + std::to_string(inputs[b].size()) + " != " + std::to_string(m_layers_sizes.at(0)) + ").");
+
+            copy_sample(inputs[b], input_rows.row(b));
+        }
+        BasicMatrix<T>::transponate(input_rows, neurons[0]);
+
+        for (unsigned int layer = 0; layer + 1 < m_layers_sizes.size(); layer++)
+        {
+            const auto& weights = m_weights[layer];
+            auto& next = neurons[layer + 1];
+            kernels::gemm(weights.size().first, columns, weights.size().second, weights.data(), weights.stride(),
+                neurons[layer].data(), neurons[layer].stride(), next.data(), next.stride());
+
+            for (unsigned int i = 0; i < m_layers_sizes[layer + 1]; i++)
+            {
+                T* row = next.row(i);
+                const T bios = m_bioses[layer](i, 0);
+                for (unsigned int b = 0; b < count; b++)
+                {
+                    row[b] += bios;
+                }
+                activator.func_inplace(row, count);
+            }
+        }
+    }
+
+    // Index of the strongest output of sample b, a column of output.
+    static int _answer(const BasicMatrix<T>& output, unsigned int b)
+    {
+        T max = -std::numeric_limits<T>::max();
+        int max_answer = -1;
+        for (unsigned int i = 0; i < output.size().first; i++)
+        {
+            if (output.unchecked(i, b) > max)
+            {
+                max = output.unchecked(i, b);
+                max_answer = i;
             }
         }
+        return max_answer;
     }
 
 private:
-    std::weak_ptr<IActivatorFunc> m_activator;
+    std::weak_ptr<BasicActivatorFunc<T>> m_activator;
     std::vector<unsigned int> m_layers_sizes;
-    std::vector<Matrix> m_sigmas;
-    std::vector<Matrix> m_neurons_layers;
-    std::vector<Matrix> m_weights;
-    std::vector<Matrix> m_bioses;
-};
\ No newline at end of file
+    std::vector<BasicMatrix<T>> m_weights;
+    std::vector<BasicMatrix<T>> m_bioses;
+    // Binary weights file the matrices view, when they were read from one.
+    std::shared_ptr<WeightsFile> m_mapping;
+
+    SampleWorkspace m_sample;
+    BatchWorkspace m_batch;
+    AnalyzeWorkspace m_analyze;
+};
+
+// float halves the memory traffic of every weight read and doubles the SIMD width,
+// BasicNeuroNet<double> remains available as a reference.
+using NeuroNet = BasicNeuroNet<float>;
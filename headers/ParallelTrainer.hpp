@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NeuroNet.hpp"
+#include "WorkerPool.hpp"
+
+// Data-parallel mini-batch training. Every batch is cut into one contiguous slice
+// per worker; each worker runs the forward and backward GEMMs for its slice on its
+// own workspace (activations, sigmas and gradients), so nothing is shared while the
+// network is only read. The reduction needs no locks either: every worker then sums
+// all workspaces over its own share of the weight rows and applies the update to
+// them, so the reduction is split as evenly as the update itself. The result is one
+// weight update per batch, equal to NeuroNet::train_batch() up to summation order.
+// Slices below a few dozen samples leave the GEMMs too small to pay off, size the
+// batch as a multiple of threads().
+template<typename T>
+class BasicParallelTrainer
+{
+public:
+    using Workspace = typename BasicNeuroNet<T>::BatchWorkspace;
+
+    // threads == 0 takes one worker per hardware thread.
+    BasicParallelTrainer(BasicNeuroNet<T>& net, unsigned int threads = 0)
+        : m_net(net)
+        , m_pool(threads)
+        , m_workspaces(m_pool.size())
+        , m_good(m_pool.size())
+    {
+        for (const auto& workspace : m_workspaces)
+        {
+            m_reduce_order.push_back(&workspace);
+        }
+    }
+
+    unsigned int threads() const
+    {
+        return m_pool.size();
+    }
+
+    // Same contract as NeuroNet::train_batch().
+    template<typename Sample>
+    int train_batch(const std::vector<int>& labels, const std::vector<Sample>& inputs, double study_coef = 1)
+    {
+        if (labels.size() != inputs.size())
+            throw std::runtime_error("ParallelTrainer::train_batch() labels and inputs counts differ (" + std::to_string(labels.size()) + " != " + std::to_string(inputs.size()) + ").");
+        if (inputs.empty())
+            return 0;
+
+        const std::size_t batch = inputs.size();
+        const unsigned int workers = threads();
+
+        m_pool.run([&](unsigned int worker) {
+            const std::size_t first = batch * worker / workers;
+            const std::size_t last = batch * (worker + 1) / workers;
+            m_good[worker] = m_net.compute_gradients(labels.data() + first, inputs.data() + first, last - first, m_workspaces[worker]);
+        });
+
+        m_pool.run([&](unsigned int worker) {
+            m_net.apply_gradients(m_reduce_order, study_coef, worker, workers);
+        });
+
+        int good = 0;
+        for (auto count : m_good)
+        {
+            good += count;
+        }
+        return good;
+    }
+
+private:
+    BasicNeuroNet<T>& m_net;
+    WorkerPool m_pool;
+    std::vector<Workspace> m_workspaces;
+    std::vector<const Workspace*> m_reduce_order;
+    std::vector<int> m_good;
+};
+
+using ParallelTrainer = BasicParallelTrainer<float>;
@@ -0,0 +1,382 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Dataset.hpp"
+#include "IActivatorFunc.hpp"
+#include "NeuroNet.hpp"
+#include "kernels/Dense.hpp"
+#include "kernels/Int8.hpp"
+
+// Post-training int8 quantization of a trained NeuroNet for serving.
+//
+// Weights are quantized symmetrically per output neuron (per channel):
+//     w ~ weight_scale[i] * q_w,              q_w in [-127, 127]
+// Layer inputs are quantized asymmetrically, with the range calibrated on sample data:
+//     x ~ input_scale * (q_x - zero_point),   q_x in [0, 127]
+// so W*x + b ~ weight_scale[i] * input_scale * (sum(q_w * q_x) - zero_point * sum(q_w) + q_b)
+// with q_b the int32 bias. Activations run in float on the dequantized sums.
+class QuantizedNeuroNet
+{
+public:
+    // Inputs are 7 bit so AVX2 maddubs can't saturate (see kernels/Int8.hpp).
+    static constexpr int ACTIVATION_MAX = 127;
+    static constexpr int WEIGHT_MAX = 127;
+    // Rows are padded to whole 64 byte vectors, padding weights are zero.
+    static constexpr unsigned int ROW_ALIGNMENT = 64;
+
+    QuantizedNeuroNet(std::weak_ptr<IActivatorFunc> activator_func)
+        : m_activator(activator_func)
+    {}
+
+    // Buffers of one analyze() per layer. The network keeps one for the plain
+    // overload; threads sharing a network pass their own.
+    struct Workspace
+    {
+        struct Layer
+        {
+            std::vector<std::uint8_t> quantized_input;
+            std::vector<std::int32_t> accumulators;
+            std::vector<float> outputs_values;
+        };
+
+        std::vector<Layer> layers;
+    };
+
+    // Quantizes net, input ranges are calibrated by running the float model over calibration.
+    void quantize(const NeuroNet& net, const Dataset& calibration)
+    {
+        const auto activator = m_activator.lock();
+        if (not activator)
+            throw std::runtime_error("Activator func is nulptr.");
+        if (calibration.empty())
+            throw std::runtime_error("QuantizedNeuroNet::quantize() calibration set is empty.");
+
+        const auto& sizes = net.layers_sizes();
+        const auto ranges = _calibrate(net, *activator, calibration);
+
+        m_layers.clear();
+        for (unsigned int layer = 0; layer + 1 < sizes.size(); layer++)
+        {
+            Layer quantized;
+            quantized.inputs = sizes[layer];
+            quantized.outputs = sizes[layer + 1];
+            quantized.stride = _padded(quantized.inputs);
+
+            const float min = std::min(ranges[layer].first, 0.0f);
+            const float max = std::max(ranges[layer].second, 0.0f);
+            quantized.input_scale = max > min ? (max - min) / ACTIVATION_MAX : 1.0f;
+            quantized.zero_point = std::clamp(static_cast<int>(std::lround(-min / quantized.input_scale)), 0, ACTIVATION_MAX);
+
+            quantized.weights.assign(static_cast<std::size_t>(quantized.outputs) * quantized.stride, 0);
+            quantized.weight_scales.resize(quantized.outputs);
+            quantized.bioses.resize(quantized.outputs);
+
+            const auto& weights = net.weights().at(layer);
+            const auto& bioses = net.bioses().at(layer);
+            for (unsigned int i = 0; i < quantized.outputs; i++)
+            {
+                const float* row = weights.row(i);
+                float max_abs = 0;
+                for (unsigned int j = 0; j < quantized.inputs; j++)
+                {
+                    max_abs = std::max(max_abs, static_cast<float>(std::abs(row[j])));
+                }
+
+                const float scale = max_abs > 0 ? max_abs / WEIGHT_MAX : 1.0f;
+                quantized.weight_scales[i] = scale;
+
+                std::int8_t* q_row = quantized.weights.data() + static_cast<std::size_t>(i) * quantized.stride;
+                for (unsigned int j = 0; j < quantized.inputs; j++)
+                {
+                    q_row[j] = static_cast<std::int8_t>(std::clamp(static_cast<int>(std::lround(row[j] / scale)), -WEIGHT_MAX, WEIGHT_MAX));
+                }
+
+                quantized.bioses[i] = static_cast<std::int32_t>(std::lround(bioses(i, 0) / (scale * quantized.input_scale)));
+            }
+
+            _finalize(quantized);
+            m_layers.push_back(std::move(quantized));
+        }
+    }
+
+    template<typename U>
+    int analyze(const std::vector<U>& input)
+    {
+        return analyze(input, m_workspace);
+    }
+
+    template<typename U>
+    int analyze(const std::vector<U>& input, Workspace& workspace) const
+    {
+        if (m_layers.empty())
+            throw std::runtime_error("QuantizedNeuroNet::analyze() network is not quantized.");
+        if (input.size() != m_layers.front().inputs)
+            throw std::runtime_error("Input data size doesn't match the actual input layer size (" + std::to_string(input.size()) + " != " + std::to_string(m_layers.front().inputs) + ").");
+
+        const auto activator = m_activator.lock();
+        if (not activator)
+            throw std::runtime_error("Activator func is nulptr.");
+
+        _reserve(workspace);
+        _quantize_input(m_layers.front(), input.data(), workspace.layers.front());
+
+        for (unsigned int layer = 0; layer < m_layers.size(); layer++)
+        {
+            const auto& current = m_layers[layer];
+            auto& buffers = workspace.layers[layer];
+            kernels::gemv_u8s8(current.outputs, current.stride, current.weights.data(), current.stride, buffers.quantized_input.data(), buffers.accumulators.data());
+
+            for (unsigned int i = 0; i < current.outputs; i++)
+            {
+                const std::int32_t sum = buffers.accumulators[i] - current.zero_point * current.row_sums[i] + current.bioses[i];
+                buffers.outputs_values[i] = current.weight_scales[i] * current.input_scale * static_cast<float>(sum);
+            }
+            activator->func_inplace(buffers.outputs_values.data(), current.outputs);
+
+            if (layer + 1 < m_layers.size())
+                _quantize_input(m_layers[layer + 1], buffers.outputs_values.data(), workspace.layers[layer + 1]);
+        }
+
+        const auto& output = workspace.layers.back().outputs_values;
+        return static_cast<int>(std::max_element(output.begin(), output.end()) - output.begin());
+    }
+
+    std::vector<unsigned int> layers_sizes() const
+    {
+        std::vector<unsigned int> result;
+        for (const auto& layer : m_layers)
+        {
+            result.push_back(layer.inputs);
+        }
+        if (not m_layers.empty())
+            result.push_back(m_layers.back().outputs);
+
+        return result;
+    }
+
+    // Bytes taken by the quantized weights and biases.
+    std::size_t weights_bytes() const
+    {
+        std::size_t result = 0;
+        for (const auto& layer : m_layers)
+        {
+            result += static_cast<std::size_t>(layer.inputs) * layer.outputs + layer.bioses.size() * sizeof(std::int32_t);
+        }
+        return result;
+    }
+
+    // Binary layout: "NDQ8", version, layers count, then per layer inputs, outputs,
+    // input scale, zero point, weight scales, int32 biases and unpadded int8 weights.
+    void save(const std::string& filename) const
+    {
+        std::ofstream output(filename, std::ios::binary);
+        if (not output)
+        {
+            throw std::runtime_error("Couldn't open file \"" + filename + "\".");
+        }
+
+        output.write(MAGIC, sizeof(MAGIC));
+        _write(output, VERSION);
+        _write(output, static_cast<std::uint32_t>(m_layers.size()));
+        for (const auto& layer : m_layers)
+        {
+            _write(output, layer.inputs);
+            _write(output, layer.outputs);
+            _write(output, layer.input_scale);
+            _write(output, layer.zero_point);
+            output.write(reinterpret_cast<const char*>(layer.weight_scales.data()), layer.weight_scales.size() * sizeof(float));
+            output.write(reinterpret_cast<const char*>(layer.bioses.data()), layer.bioses.size() * sizeof(std::int32_t));
+            for (unsigned int i = 0; i < layer.outputs; i++)
+            {
+                output.write(reinterpret_cast<const char*>(layer.weights.data() + static_cast<std::size_t>(i) * layer.stride), layer.inputs);
+            }
+        }
+
+        if (not output)
+            throw std::runtime_error("Couldn't write file \"" + filename + "\".");
+    }
+
+    void load(const std::string& filename)
+    {
+        std::ifstream input(filename, std::ios::binary);
+        if (not input)
+        {
+            throw std::runtime_error("Couldn't find file \"" + filename + "\".");
+        }
+
+        char magic[sizeof(MAGIC)];
+        input.read(magic, sizeof(magic));
+        if (not input or std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 or _read<std::uint32_t>(input) != VERSION)
+            throw std::runtime_error("\"" + filename + "\" is not a quantized weights file.");
+
+        const auto layers_count = _read<std::uint32_t>(input);
+        std::vector<Layer> layers(layers_count);
+        for (auto& layer : layers)
+        {
+            layer.inputs = _read<unsigned int>(input);
+            layer.outputs = _read<unsigned int>(input);
+            layer.stride = _padded(layer.inputs);
+            layer.input_scale = _read<float>(input);
+            layer.zero_point = _read<std::int32_t>(input);
+
+            layer.weight_scales.resize(layer.outputs);
+            layer.bioses.resize(layer.outputs);
+            layer.weights.assign(static_cast<std::size_t>(layer.outputs) * layer.stride, 0);
+            input.read(reinterpret_cast<char*>(layer.weight_scales.data()), layer.weight_scales.size() * sizeof(float));
+            input.read(reinterpret_cast<char*>(layer.bioses.data()), layer.bioses.size() * sizeof(std::int32_t));
+            for (unsigned int i = 0; i < layer.outputs; i++)
+            {
+                input.read(reinterpret_cast<char*>(layer.weights.data() + static_cast<std::size_t>(i) * layer.stride), layer.inputs);
+            }
+
+            if (not input)
+                throw std::runtime_error("Truncated quantized weights file \"" + filename + "\".");
+
+            _finalize(layer);
+        }
+
+        m_layers = std::move(layers);
+    }
+
+private:
+    struct Layer
+    {
+        unsigned int inputs = 0;
+        unsigned int outputs = 0;
+        unsigned int stride = 0;
+
+        float input_scale = 1;
+        std::int32_t zero_point = 0;
+
+        std::vector<std::int8_t> weights;
+        std::vector<float> weight_scales;
+        std::vector<std::int32_t> bioses;
+        std::vector<std::int32_t> row_sums;
+    };
+
+    static constexpr char MAGIC[4] = {'N', 'D', 'Q', '8'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    static unsigned int _padded(unsigned int size)
+    {
+        return (size + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+    }
+
+    // Precomputes sum(q_w) per row for the zero point correction.
+    static void _finalize(Layer& layer)
+    {
+        layer.row_sums.assign(layer.outputs, 0);
+        for (unsigned int i = 0; i < layer.outputs; i++)
+        {
+            const std::int8_t* row = layer.weights.data() + static_cast<std::size_t>(i) * layer.stride;
+            for (unsigned int j = 0; j < layer.inputs; j++)
+            {
+                layer.row_sums[i] += row[j];
+            }
+        }
+    }
+
+    // Sizes the workspace for the current layers, allocating only when they changed.
+    void _reserve(Workspace& workspace) const
+    {
+        bool fits = workspace.layers.size() == m_layers.size();
+        for (unsigned int i = 0; fits and i < m_layers.size(); i++)
+        {
+            fits = workspace.layers[i].quantized_input.size() == m_layers[i].stride and workspace.layers[i].outputs_values.size() == m_layers[i].outputs;
+        }
+        if (fits)
+            return;
+
+        workspace.layers.resize(m_layers.size());
+        for (unsigned int i = 0; i < m_layers.size(); i++)
+        {
+            // The padding of the quantized input must stay zero, gemv_u8s8 reads whole rows.
+            workspace.layers[i].quantized_input.assign(m_layers[i].stride, 0);
+            workspace.layers[i].accumulators.assign(m_layers[i].outputs, 0);
+            workspace.layers[i].outputs_values.assign(m_layers[i].outputs, 0);
+        }
+    }
+
+    template<typename U>
+    static void _quantize_input(const Layer& layer, const U* values, Workspace::Layer& buffers)
+    {
+        const float inverse_scale = 1.0f / layer.input_scale;
+        for (unsigned int j = 0; j < layer.inputs; j++)
+        {
+            const int q = static_cast<int>(std::lround(static_cast<float>(values[j]) * inverse_scale)) + layer.zero_point;
+            buffers.quantized_input[j] = static_cast<std::uint8_t>(std::clamp(q, 0, ACTIVATION_MAX));
+        }
+    }
+
+    // Min and max of every layer's input over the calibration samples.
+    static std::vector<std::pair<float, float>> _calibrate(const NeuroNet& net, IActivatorFunc& activator, const Dataset& calibration)
+    {
+        const auto& sizes = net.layers_sizes();
+        std::vector<std::pair<float, float>> ranges(sizes.size() - 1, {std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()});
+
+        std::vector<MatrixF> neurons;
+        for (auto size : sizes)
+        {
+            neurons.emplace_back(size, 1);
+        }
+
+        const auto activate = [&activator](float* values, unsigned int count) {
+            activator.func_inplace(values, count);
+        };
+
+        for (const auto& sample : calibration)
+        {
+            if (sample.second.size() != sizes.front())
+                throw std::runtime_error("QuantizedNeuroNet::quantize() calibration sample size doesn't match the input layer.");
+
+            for (unsigned int i = 0; i < sizes.front(); i++)
+            {
+                neurons[0](i, 0) = sample.second[i];
+            }
+
+            for (unsigned int layer = 0; layer + 1 < sizes.size(); layer++)
+            {
+                const float* values = neurons[layer].data();
+                for (unsigned int i = 0; i < sizes[layer]; i++)
+                {
+                    ranges[layer].first = std::min(ranges[layer].first, static_cast<float>(values[i]));
+                    ranges[layer].second = std::max(ranges[layer].second, static_cast<float>(values[i]));
+                }
+
+                const auto& weights = net.weights()[layer];
+                kernels::dense_forward(weights.size().first, weights.size().second, weights.data(), weights.stride(),
+                    neurons[layer].data(), net.bioses()[layer].data(), neurons[layer + 1].data(), activate);
+            }
+        }
+
+        return ranges;
+    }
+
+    template<typename V>
+    static void _write(std::ofstream& output, V value)
+    {
+        output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename V>
+    static V _read(std::ifstream& input)
+    {
+        V value {};
+        input.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+private:
+    std::weak_ptr<IActivatorFunc> m_activator;
+    std::vector<Layer> m_layers;
+    Workspace m_workspace;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Storage type of the pixels of a dataset file.
+enum class PixelType : std::uint32_t
+{
+    UInt8 = 0,    // 0..255, read as value / 255
+    Float32 = 1,  // already in [0, 1]
+};
+
+// Non-owning view of one sample's pixels inside a mapped dataset file. Values are
+// normalised to [0, 1] only when they are fed to a network (see copy_sample), so
+// uint8 data stays uint8 in memory.
+class SampleView
+{
+public:
+    SampleView(const void* pixels, unsigned int size, PixelType type)
+        : m_pixels(pixels)
+        , m_size(size)
+        , m_type(type)
+    {}
+
+    unsigned int size() const
+    {
+        return m_size;
+    }
+
+    PixelType pixel_type() const
+    {
+        return m_type;
+    }
+
+    const void* data() const
+    {
+        return m_pixels;
+    }
+
+    float operator[](unsigned int i) const
+    {
+        if (m_type == PixelType::UInt8)
+            return static_cast<const std::uint8_t*>(m_pixels)[i] * (1.0f / 255);
+        return static_cast<const float*>(m_pixels)[i];
+    }
+
+    // Normalised copy of the pixels into a network's input layer.
+    template<typename T>
+    void copy_to(T* dst) const
+    {
+        if (m_type == PixelType::UInt8)
+        {
+            const auto* pixels = static_cast<const std::uint8_t*>(m_pixels);
+            for (unsigned int i = 0; i < m_size; i++)
+            {
+                dst[i] = static_cast<T>(pixels[i] * (1.0f / 255));
+            }
+        }
+        else
+        {
+            const auto* pixels = static_cast<const float*>(m_pixels);
+            for (unsigned int i = 0; i < m_size; i++)
+            {
+                dst[i] = static_cast<T>(pixels[i]);
+            }
+        }
+    }
+
+private:
+    const void* m_pixels;
+    unsigned int m_size;
+    PixelType m_type;
+};
+
+// Zero-copy views of in-memory samples, for code that handles both kinds alike.
+inline SampleView view_of(const std::vector<float>& sample)
+{
+    return SampleView(sample.data(), sample.size(), PixelType::Float32);
+}
+
+inline SampleView view_of(const SampleView& sample)
+{
+    return sample;
+}
+
+// Writes a sample into a network's input layer; the networks accept anything with
+// size() and a copy_sample overload.
+template<typename T, typename U>
+inline void copy_sample(const std::vector<U>& sample, T* dst)
+{
+    for (unsigned int i = 0; i < sample.size(); i++)
+    {
+        dst[i] = static_cast<T>(sample[i]);
+    }
+}
+
+template<typename T>
+inline void copy_sample(const SampleView& sample, T* dst)
+{
+    sample.copy_to(dst);
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "MappedFile.hpp"
+
+// Binary weights file, little endian:
+//     WeightsFileHeader                      64 bytes
+//     layer sizes, one uint32 per layer      64 byte aligned
+//     WeightsSection table                   weights and bioses of every layer in turn
+//     section data                           each 64 byte aligned, rows of `stride` elements
+// Rows are laid out with Matrix's own padded stride, 1 for the bioses, so a section
+// maps straight into a Matrix; sections with any other stride are rejected. The
+// checksum covers everything after the header.
+enum class WeightsDType : std::uint32_t
+{
+    Float32 = 0,
+    Float64 = 1,
+};
+
+struct WeightsFileHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t dtype;
+    std::uint32_t layers;
+    std::uint64_t checksum;
+    std::uint64_t file_size;
+    std::uint8_t reserved[32];
+};
+
+struct WeightsSection
+{
+    std::uint64_t offset;
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t stride;
+    std::uint32_t reserved[3];
+};
+
+static_assert(sizeof(WeightsFileHeader) == 64, "The weights header is 64 bytes on disk.");
+static_assert(sizeof(WeightsSection) == 32, "A weights section entry is 32 bytes on disk.");
+
+constexpr char WEIGHTS_FILE_MAGIC[4] = {'N', 'D', 'W', 'T'};
+constexpr std::uint32_t WEIGHTS_FILE_VERSION = 1;
+constexpr std::size_t WEIGHTS_FILE_ALIGNMENT = 64;
+
+template<typename T>
+constexpr WeightsDType weights_dtype_of()
+{
+    static_assert(std::is_same_v<T, float> or std::is_same_v<T, double>, "Weights are stored as float32 or float64.");
+    return std::is_same_v<T, float> ? WeightsDType::Float32 : WeightsDType::Float64;
+}
+
+// 64-bit checksum in four independent lanes, so checking a file costs a fraction
+// of the page faults that load it.
+inline std::uint64_t weights_checksum(const std::uint8_t* data, std::size_t size)
+{
+    constexpr std::uint64_t PRIME = 0x100000001b3ull;
+    std::uint64_t lanes[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9ce484222325cbf2ull, 0x2325cbf29ce48422ull};
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (unsigned int lane = 0; lane < 4; lane++)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * PRIME;
+        }
+    }
+    for (; i < size; i++)
+    {
+        lanes[0] = (lanes[0] ^ data[i]) * PRIME;
+    }
+
+    std::uint64_t result = size;
+    for (const auto lane : lanes)
+    {
+        result = (result ^ lane) * PRIME;
+        result ^= result >> 29;
+    }
+    return result;
+}
+
+inline bool is_weights_file(const std::string& filename)
+{
+    char magic[sizeof(WEIGHTS_FILE_MAGIC)] = {};
+    std::ifstream(filename, std::ios::binary).read(magic, sizeof(magic));
+    return std::memcmp(magic, WEIGHTS_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+// A binary weights file mapped copy-on-write: matrices may view its sections
+// directly and training may update them without touching the file.
+class WeightsFile
+{
+public:
+    explicit WeightsFile(const std::string& filename)
+        : m_file(filename, MappedFile::Access::CopyOnWrite)
+    {
+        if (m_file.size() < sizeof(WeightsFileHeader))
+            throw std::runtime_error("\"" + filename + "\" is not a weights file.");
+
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        if (std::memcmp(m_header.magic, WEIGHTS_FILE_MAGIC, sizeof(WEIGHTS_FILE_MAGIC)) != 0)
+            throw std::runtime_error("\"" + filename + "\" is not a weights file.");
+        if (m_header.version != WEIGHTS_FILE_VERSION)
+            throw std::runtime_error("\"" + filename + "\" has unsupported weights version " + std::to_string(m_header.version) + ".");
+        if (m_header.dtype > static_cast<std::uint32_t>(WeightsDType::Float64))
+            throw std::runtime_error("\"" + filename + "\" has unknown dtype.");
+        if (m_header.file_size != m_file.size() or m_header.layers < 2)
+            throw std::runtime_error("Truncated weights file \"" + filename + "\".");
+        if (not fits_in_file(sections_offset(m_header.layers), sections_count(), sizeof(WeightsSection), m_file.size()))
+            throw std::runtime_error("Truncated weights file \"" + filename + "\".");
+        if (weights_checksum(m_file.data() + sizeof(m_header), m_file.size() - sizeof(m_header)) != m_header.checksum)
+            throw std::runtime_error("Checksum mismatch in weights file \"" + filename + "\".");
+
+        const auto* sizes = reinterpret_cast<const std::uint32_t*>(m_file.data() + sizes_offset());
+        m_layers_sizes.assign(sizes, sizes + m_header.layers);
+
+        const std::size_t element_size = dtype() == WeightsDType::Float32 ? sizeof(float) : sizeof(double);
+        for (unsigned int i = 0; i < sections_count(); i++)
+        {
+            const auto& entry = section(i);
+            const unsigned int layer = i / 2;
+            const bool fits_topology = entry.rows == m_layers_sizes[layer + 1] and entry.cols == (i % 2 == 0 ? m_layers_sizes[layer] : 1);
+            // The checksum only catches accidents, a crafted file may still wrap the end of a section around.
+            const bool fits_file = entry.offset % WEIGHTS_FILE_ALIGNMENT == 0 and fits_in_file(entry.offset, entry.rows, std::uint64_t(entry.stride) * element_size, m_file.size());
+            // The dense kernels take the stride of a Matrix as given, and the bioses as plain arrays.
+            const unsigned int natural_stride = dtype() == WeightsDType::Float32 ? BasicMatrix<float>::natural_stride(entry.cols) : BasicMatrix<double>::natural_stride(entry.cols);
+            if (not fits_topology or not fits_file or entry.stride != natural_stride)
+                throw std::runtime_error("Malformed section " + std::to_string(i) + " in weights file \"" + filename + "\".");
+        }
+    }
+
+    const std::vector<unsigned int>& layers_sizes() const
+    {
+        return m_layers_sizes;
+    }
+
+    WeightsDType dtype() const
+    {
+        return static_cast<WeightsDType>(m_header.dtype);
+    }
+
+    // Weights of layer l are section 2 * l, its bioses section 2 * l + 1.
+    unsigned int sections_count() const
+    {
+        return 2 * (m_header.layers - 1);
+    }
+
+    const WeightsSection& section(unsigned int i) const
+    {
+        return reinterpret_cast<const WeightsSection*>(m_file.data() + sections_offset(m_header.layers))[i];
+    }
+
+    // Elements of section i, T must match dtype().
+    template<typename T>
+    T* section_data(unsigned int i)
+    {
+        if (weights_dtype_of<T>() != dtype())
+            throw std::runtime_error("WeightsFile::section_data() dtype doesn't match.");
+        return reinterpret_cast<T*>(m_file.data() + section(i).offset);
+    }
+
+    static std::size_t sizes_offset()
+    {
+        return sizeof(WeightsFileHeader);
+    }
+
+    static std::size_t sections_offset(unsigned int layers)
+    {
+        return aligned(sizes_offset() + layers * sizeof(std::uint32_t));
+    }
+
+    static std::size_t aligned(std::size_t offset)
+    {
+        return (offset + WEIGHTS_FILE_ALIGNMENT - 1) / WEIGHTS_FILE_ALIGNMENT * WEIGHTS_FILE_ALIGNMENT;
+    }
+
+private:
+    MappedFile m_file;
+    WeightsFileHeader m_header;
+    std::vector<unsigned int> m_layers_sizes;
+};
+
+// Writes weights[l] and bioses[l] of every layer in the binary format. The file
+// is written aside and renamed over filename, so a network that still maps the
+// old file keeps working.
+template<typename T>
+void write_weights_file(const std::string& filename, const std::vector<unsigned int>& layers_sizes,
+    const std::vector<BasicMatrix<T>>& weights, const std::vector<BasicMatrix<T>>& bioses)
+{
+    if (layers_sizes.size() < 2 or weights.size() != layers_sizes.size() - 1 or bioses.size() != weights.size())
+        throw std::runtime_error("write_weights_file() layers don't match the topology.");
+
+    std::vector<const BasicMatrix<T>*> matrices;
+    for (std::size_t l = 0; l < weights.size(); l++)
+    {
+        matrices.push_back(&weights[l]);
+        matrices.push_back(&bioses[l]);
+    }
+
+    std::vector<WeightsSection> sections(matrices.size());
+    std::size_t offset = WeightsFile::aligned(WeightsFile::sections_offset(layers_sizes.size()) + sections.size() * sizeof(WeightsSection));
+    for (std::size_t i = 0; i < matrices.size(); i++)
+    {
+        sections[i] = {};
+        sections[i].offset = offset;
+        sections[i].rows = matrices[i]->size().first;
+        sections[i].cols = matrices[i]->size().second;
+        sections[i].stride = matrices[i]->stride();
+        offset = WeightsFile::aligned(offset + static_cast<std::size_t>(sections[i].rows) * sections[i].stride * sizeof(T));
+    }
+
+    std::vector<std::uint8_t> bytes(offset, 0);
+    for (std::size_t i = 0; i < layers_sizes.size(); i++)
+    {
+        const std::uint32_t size = layers_sizes[i];
+        std::memcpy(bytes.data() + WeightsFile::sizes_offset() + i * sizeof(size), &size, sizeof(size));
+    }
+    std::memcpy(bytes.data() + WeightsFile::sections_offset(layers_sizes.size()), sections.data(), sections.size() * sizeof(WeightsSection));
+    for (std::size_t i = 0; i < matrices.size(); i++)
+    {
+        // Row padding is zero in every Matrix, so the whole buffer is copied as it is.
+        std::memcpy(bytes.data() + sections[i].offset, matrices[i]->data(), static_cast<std::size_t>(sections[i].rows) * sections[i].stride * sizeof(T));
+    }
+
+    WeightsFileHeader header {};
+    std::memcpy(header.magic, WEIGHTS_FILE_MAGIC, sizeof(header.magic));
+    header.version = WEIGHTS_FILE_VERSION;
+    header.dtype = static_cast<std::uint32_t>(weights_dtype_of<T>());
+    header.layers = layers_sizes.size();
+    header.file_size = bytes.size();
+    header.checksum = weights_checksum(bytes.data() + sizeof(header), bytes.size() - sizeof(header));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary);
+        if (not output)
+            throw std::runtime_error("Couldn't open file \"" + temporary + "\".");
+        output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        if (not output)
+            throw std::runtime_error("Couldn't write file \"" + temporary + "\".");
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+        throw std::runtime_error("Couldn't replace file \"" + filename + "\".");
+}
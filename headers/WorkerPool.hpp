@@ -0,0 +1,125 @@
+#pragma once
+
+#include <condition_variable>
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that run one job at a time on every worker. The calling
+// thread takes part as worker 0, so WorkerPool(4) starts three threads. run()
+// returns once all workers are done, which makes each call a barrier.
+class WorkerPool
+{
+public:
+    // size == 0 takes one worker per hardware thread.
+    explicit WorkerPool(unsigned int size = 0)
+    {
+        if (size == 0)
+            size = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned int worker = 1; worker < size; worker++)
+        {
+            m_threads.emplace_back(&WorkerPool::_work, this, worker);
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    unsigned int size() const
+    {
+        return m_threads.size() + 1;
+    }
+
+    // Calls job(worker) once for every worker in [0, size()). The first exception
+    // thrown by any worker is rethrown here after all of them have finished.
+    void run(const std::function<void(unsigned int)>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_pending = m_threads.size();
+            m_error = nullptr;
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        _call(job, 0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0; });
+        m_job = nullptr;
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+private:
+    void _work(unsigned int worker)
+    {
+        std::size_t seen = 0;
+        while (true)
+        {
+            const std::function<void(unsigned int)>* job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [this, seen] { return m_stop or m_generation != seen; });
+                if (m_stop)
+                    return;
+
+                seen = m_generation;
+                job = m_job;
+            }
+
+            _call(*job, worker);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void _call(const std::function<void(unsigned int)>& job, unsigned int worker)
+    {
+        try
+        {
+            job(worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (not m_error)
+                m_error = std::current_exception();
+        }
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+
+    const std::function<void(unsigned int)>* m_job = nullptr;
+    std::size_t m_generation = 0;
+    std::size_t m_pending = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+};
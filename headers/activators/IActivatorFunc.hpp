@@ -2,11 +2,53 @@
 
 #include "Matrix.hpp"
 
-class IActivatorFunc
+template<typename T>
+class BasicActivatorFunc
 {
 public:
-    virtual double func(double x) = 0; 
-    virtual Matrix func(const Matrix& x) = 0; 
-    virtual double derivative_func(double x) = 0;
-    virtual Matrix derivative_func(const Matrix& x) = 0;
-};
\ No newline at end of file
+    virtual ~BasicActivatorFunc() = default;
+
+    virtual T func(T x) = 0; 
+    virtual BasicMatrix<T> func(const BasicMatrix<T>& x) = 0; 
+    // Applies func to count contiguous values without allocating.
+    virtual void func_inplace(T* values, unsigned int count) = 0;
+    virtual T derivative_func(T x) = 0;
+    virtual BasicMatrix<T> derivative_func(const BasicMatrix<T>& x) = 0;
+    // Replaces count contiguous values with derivative_func of them without allocating.
+    virtual void derivative_inplace(T* values, unsigned int count) = 0;
+    // The derivative at x given only y = func(x), what the forward pass keeps.
+    virtual T derivative_from_output(T y) = 0;
+    // Backward step of the activation: multiplies count gradients by the derivative
+    // at the points whose activations are outputs, without transcendental math.
+    virtual void backward_inplace(const T* outputs, T* gradients, unsigned int count) = 0;
+
+    // Matrix forms of the in-place overloads; row padding is left alone.
+    void func_inplace(BasicMatrix<T>& x)
+    {
+        _for_each_row(x, [this](T* values, unsigned int count) { func_inplace(values, count); });
+    }
+
+    void derivative_inplace(BasicMatrix<T>& x)
+    {
+        _for_each_row(x, [this](T* values, unsigned int count) { derivative_inplace(values, count); });
+    }
+
+protected:
+    template<typename Op>
+    static void _for_each_row(BasicMatrix<T>& x, Op&& op)
+    {
+        const auto size = x.size();
+        if (x.stride() == size.second)
+        {
+            op(x.data(), size.first * size.second);
+            return;
+        }
+
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            op(x.row(i), size.second);
+        }
+    }
+};
+
+using IActivatorFunc = BasicActivatorFunc<float>;
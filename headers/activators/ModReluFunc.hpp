@@ -1,59 +1,75 @@
 #pragma once
 
 #include "IActivatorFunc.hpp"
+#include "kernels/Activation.hpp"
 
-class ModReluFunc : public IActivatorFunc
+template<typename T>
+class BasicModReluFunc : public BasicActivatorFunc<T>
 {
+    static constexpr T SLOPE = static_cast<T>(0.01);
+
 public:
-    double func(double x) override 
+    using BasicActivatorFunc<T>::func_inplace;
+    using BasicActivatorFunc<T>::derivative_inplace;
+
+    T func(T x) override 
     {
         if (x < 0)
-            return 0.01 * x;
+            return SLOPE * x;
         else if (0 <= x and x <= 1)
             return x;
         else // x > 1
-            return 1 + 0.01 * (x - 1);
+            return 1 + SLOPE * (x - 1);
     }
 
-    Matrix func(const Matrix& x) override
+    BasicMatrix<T> func(const BasicMatrix<T>& x) override
     {
-        const auto size = x.size();
-        Matrix result(size.first, size.second);
-
-        for(int i = 0; i < size.first; i++)
-        {
-            for(int j = 0; j < size.second; j++)
-            {
-                result(i, j) = func(x(i, j));
-            }
-        }
+        BasicMatrix<T> result = x;
+        func_inplace(result);
 
         return result;
     }
 
-    double derivative_func(double x) override
+    // Branch-free, same values as func(T).
+    void func_inplace(T* values, unsigned int count) override
+    {
+        kernels::mod_relu(values, count, SLOPE);
+    }
+
+    T derivative_func(T x) override
     {
         if (x < 0)
-            return 0.01;
+            return SLOPE;
         else if (0 <= x and x <= 1)
             return 1;
         else // x > 1
-            return 0.01;
+            return SLOPE;
     }
 
-    Matrix derivative_func(const Matrix& x) override
+    BasicMatrix<T> derivative_func(const BasicMatrix<T>& x) override
     {
-        const auto size = x.size();
-        Matrix result(size.first, size.second);
-
-        for(int i = 0; i < size.first; i++)
-        {
-            for(int j = 0; j < size.second; j++)
-            {
-                result(i, j) = derivative_func(x(i, j));
-            }
-        }
+        BasicMatrix<T> result = x;
+        derivative_inplace(result);
 
         return result;
     }
-};
\ No newline at end of file
+
+    void derivative_inplace(T* values, unsigned int count) override
+    {
+        kernels::mod_relu_derivative(values, count, SLOPE);
+    }
+
+    // func keeps every piece on its side of 0 and 1, so y tells the piece as x does,
+    // except within rounding of the kinks, where either slope is a subgradient.
+    T derivative_from_output(T y) override
+    {
+        return derivative_func(y);
+    }
+
+    void backward_inplace(const T* outputs, T* gradients, unsigned int count) override
+    {
+        kernels::mod_relu_backward(outputs, gradients, count, SLOPE);
+    }
+};
+
+using ModReluFunc = BasicModReluFunc<float>;
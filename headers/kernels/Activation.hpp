@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "CpuFeatures.hpp"
+#include "detail/SimdAvx2.hpp"
+#include "detail/SimdAvx512.hpp"
+
+// In-place elementwise activations. float sigmoid uses a vectorised exp: Cody-Waite
+// range reduction to r in [-ln2/2, ln2/2], the degree 5 Cephes polynomial and a
+// power of two built in the exponent bits. Over [-87, 88] exp has a relative error
+// below 2.5e-7 (2 ulp); sigmoid then has an absolute error below 1.2e-7 everywhere.
+// Inputs beyond that range are clamped, which only matters to exp, never to sigmoid
+// at float precision. double keeps std::exp, it is the reference precision.
+// ModRelu is computed branch-free as clamp(x, 0, 1) + slope * (x - clamp(x, 0, 1)),
+// which gives the bits of the branching definition.
+// The *_backward kernels multiply gradients by the derivative taken from the
+// activations the forward pass left, y * (1 - y) for sigmoid, so backpropagation
+// does no transcendental math at all.
+
+namespace kernels
+{
+
+namespace detail
+{
+    constexpr float EXP_MIN = -87.0f;
+    constexpr float EXP_MAX = 88.0f;
+    constexpr float LOG2E = 1.44269504088896341f;
+    constexpr float LN2_HI = 0.693359375f;
+    constexpr float LN2_LO = -2.12194440e-4f;
+    constexpr float EXP_C5 = 1.9875691500e-4f;
+    constexpr float EXP_C4 = 1.3981999507e-3f;
+    constexpr float EXP_C3 = 8.3334519073e-3f;
+    constexpr float EXP_C2 = 4.1665795894e-2f;
+    constexpr float EXP_C1 = 1.6666665459e-1f;
+    constexpr float EXP_C0 = 5.0000001201e-1f;
+    constexpr float ROUND_MAGIC = 12582912.0f;
+}
+
+namespace scalar
+{
+    inline float exp_approx(float x)
+    {
+        using namespace kernels::detail;
+
+        x = std::min(std::max(x, EXP_MIN), EXP_MAX);
+        // Adding 1.5 * 2^23 rounds to nearest even like the vector round instruction,
+        // without branches or the library call std::nearbyint is without SSE4.1.
+        const float n = (x * LOG2E + ROUND_MAGIC) - ROUND_MAGIC;
+        float r = x - n * LN2_HI;
+        r = r - n * LN2_LO;
+
+        float p = EXP_C5;
+        p = p * r + EXP_C4;
+        p = p * r + EXP_C3;
+        p = p * r + EXP_C2;
+        p = p * r + EXP_C1;
+        p = p * r + EXP_C0;
+        const float y = p * (r * r) + r + 1;
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(static_cast<std::int32_t>(n) + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return y * scale;
+    }
+
+    inline void sigmoid(float* values, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            values[i] = 1 / (1 + exp_approx(-values[i]));
+        }
+    }
+
+    inline void sigmoid(double* values, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            values[i] = 1 / (1 + std::exp(-values[i]));
+        }
+    }
+
+    // x -> sigmoid(x) * (1 - sigmoid(x))
+    template<typename T>
+    inline void sigmoid_derivative(T* values, unsigned int count)
+    {
+        sigmoid(values, count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            values[i] = values[i] * (1 - values[i]);
+        }
+    }
+
+    template<typename T>
+    inline void mod_relu(T* values, unsigned int count, T slope)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const T x = values[i];
+            const T clamped = x < 0 ? 0 : (x > 1 ? 1 : x);
+            values[i] = clamped + slope * (x - clamped);
+        }
+    }
+
+    template<typename T>
+    inline void mod_relu_derivative(T* values, unsigned int count, T slope)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            values[i] = 0 <= values[i] and values[i] <= 1 ? 1 : slope;
+        }
+    }
+
+    // gradients *= y * (1 - y), y = sigmoid(x) taken from outputs.
+    template<typename T>
+    inline void sigmoid_backward(const T* outputs, T* gradients, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            gradients[i] *= outputs[i] * (1 - outputs[i]);
+        }
+    }
+
+    // ModRelu maps [0, 1] onto itself and is monotonic, so its output falls in the
+    // same piece as its input and the derivative reads the same from either.
+    template<typename T>
+    inline void mod_relu_backward(const T* outputs, T* gradients, unsigned int count, T slope)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            gradients[i] *= 0 <= outputs[i] and outputs[i] <= 1 ? 1 : slope;
+        }
+    }
+}
+
+#ifdef KERNEL_TARGET_AVX2
+namespace avx2
+{
+    KERNEL_TARGET_AVX2 inline __m256 exp_approx(__m256 x)
+    {
+        using namespace kernels::detail;
+
+        x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_MIN)), _mm256_set1_ps(EXP_MAX));
+        const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_HI), x);
+        r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_LO), r);
+
+        __m256 p = _mm256_set1_ps(EXP_C5);
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_C4));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_C3));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_C2));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_C1));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_C0));
+        const __m256 y = _mm256_add_ps(_mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r), _mm256_set1_ps(1.0f));
+
+        const __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+    }
+
+    KERNEL_TARGET_AVX2 inline __m256 sigmoid(__m256 x)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        return _mm256_div_ps(one, _mm256_add_ps(one, exp_approx(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+    }
+
+    KERNEL_TARGET_AVX2 inline __m256 mod_relu(__m256 x, __m256 slope)
+    {
+        const __m256 clamped = _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        return _mm256_add_ps(clamped, _mm256_mul_ps(slope, _mm256_sub_ps(x, clamped)));
+    }
+
+    KERNEL_TARGET_AVX2 inline __m256 mod_relu_derivative(__m256 x, __m256 slope)
+    {
+        const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(x, _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+        return _mm256_blendv_ps(slope, _mm256_set1_ps(1.0f), inside);
+    }
+
+    // Applies op to every float of values; the tail goes through masked loads, so
+    // every element gets the same arithmetic.
+    template<typename Op>
+    KERNEL_TARGET_AVX2 inline void transform(float* values, unsigned int count, Op op)
+    {
+        unsigned int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(values + i, op(_mm256_loadu_ps(values + i)));
+        }
+        if (i < count)
+        {
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lanes);
+            _mm256_maskstore_ps(values + i, mask, op(_mm256_maskload_ps(values + i, mask)));
+        }
+    }
+
+    // gradients *= op(outputs), with the same masked tail as transform().
+    template<typename Op>
+    KERNEL_TARGET_AVX2 inline void multiply_by(const float* outputs, float* gradients, unsigned int count, Op op)
+    {
+        unsigned int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(gradients + i, _mm256_mul_ps(_mm256_loadu_ps(gradients + i), op(_mm256_loadu_ps(outputs + i))));
+        }
+        if (i < count)
+        {
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lanes);
+            const __m256 factors = op(_mm256_maskload_ps(outputs + i, mask));
+            _mm256_maskstore_ps(gradients + i, mask, _mm256_mul_ps(_mm256_maskload_ps(gradients + i, mask), factors));
+        }
+    }
+
+    // Function objects rather than lambdas: a lambda's operator() can't carry the
+    // target attribute without ABI warnings.
+    struct SigmoidOp
+    {
+        KERNEL_TARGET_AVX2 __m256 operator()(__m256 x) const { return sigmoid(x); }
+    };
+
+    struct SigmoidDerivativeOp
+    {
+        KERNEL_TARGET_AVX2 __m256 operator()(__m256 x) const
+        {
+            const __m256 y = sigmoid(x);
+            return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.0f), y));
+        }
+    };
+
+    struct SigmoidOutputDerivativeOp
+    {
+        KERNEL_TARGET_AVX2 __m256 operator()(__m256 y) const
+        {
+            return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.0f), y));
+        }
+    };
+
+    struct ModReluOp
+    {
+        float slope;
+        KERNEL_TARGET_AVX2 __m256 operator()(__m256 x) const { return mod_relu(x, _mm256_set1_ps(slope)); }
+    };
+
+    struct ModReluDerivativeOp
+    {
+        float slope;
+        KERNEL_TARGET_AVX2 __m256 operator()(__m256 x) const { return mod_relu_derivative(x, _mm256_set1_ps(slope)); }
+    };
+
+    KERNEL_TARGET_AVX2 inline void sigmoid(float* values, unsigned int count)
+    {
+        transform(values, count, SigmoidOp());
+    }
+
+    KERNEL_TARGET_AVX2 inline void sigmoid_derivative(float* values, unsigned int count)
+    {
+        transform(values, count, SigmoidDerivativeOp());
+    }
+
+    KERNEL_TARGET_AVX2 inline void mod_relu(float* values, unsigned int count, float slope)
+    {
+        transform(values, count, ModReluOp{slope});
+    }
+
+    KERNEL_TARGET_AVX2 inline void mod_relu_derivative(float* values, unsigned int count, float slope)
+    {
+        transform(values, count, ModReluDerivativeOp{slope});
+    }
+
+    KERNEL_TARGET_AVX2 inline void sigmoid_backward(const float* outputs, float* gradients, unsigned int count)
+    {
+        multiply_by(outputs, gradients, count, SigmoidOutputDerivativeOp());
+    }
+
+    KERNEL_TARGET_AVX2 inline void mod_relu_backward(const float* outputs, float* gradients, unsigned int count, float slope)
+    {
+        multiply_by(outputs, gradients, count, ModReluDerivativeOp{slope});
+    }
+}
+#endif
+
+#ifdef KERNEL_TARGET_AVX512
+namespace avx512
+{
+    KERNEL_TARGET_AVX512 inline __m512 exp_approx(__m512 x)
+    {
+        using namespace kernels::detail;
+
+        x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(EXP_MIN)), _mm512_set1_ps(EXP_MAX));
+        const __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_HI), x);
+        r = _mm512_fnmadd_ps(n, _mm512_set1_ps(LN2_LO), r);
+
+        __m512 p = _mm512_set1_ps(EXP_C5);
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_C4));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_C3));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_C2));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_C1));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(EXP_C0));
+        const __m512 y = _mm512_add_ps(_mm512_fmadd_ps(p, _mm512_mul_ps(r, r), r), _mm512_set1_ps(1.0f));
+
+        return _mm512_scalef_ps(y, n);
+    }
+
+    KERNEL_TARGET_AVX512 inline __m512 sigmoid(__m512 x)
+    {
+        const __m512 one = _mm512_set1_ps(1.0f);
+        return _mm512_div_ps(one, _mm512_add_ps(one, exp_approx(_mm512_sub_ps(_mm512_setzero_ps(), x))));
+    }
+
+    template<typename Op>
+    KERNEL_TARGET_AVX512 inline void transform(float* values, unsigned int count, Op op)
+    {
+        unsigned int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            _mm512_storeu_ps(values + i, op(_mm512_loadu_ps(values + i)));
+        }
+        if (i < count)
+        {
+            const __mmask16 mask = static_cast<__mmask16>((1u << (count - i)) - 1);
+            _mm512_mask_storeu_ps(values + i, mask, op(_mm512_maskz_loadu_ps(mask, values + i)));
+        }
+    }
+
+    template<typename Op>
+    KERNEL_TARGET_AVX512 inline void multiply_by(const float* outputs, float* gradients, unsigned int count, Op op)
+    {
+        unsigned int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            _mm512_storeu_ps(gradients + i, _mm512_mul_ps(_mm512_loadu_ps(gradients + i), op(_mm512_loadu_ps(outputs + i))));
+        }
+        if (i < count)
+        {
+            const __mmask16 mask = static_cast<__mmask16>((1u << (count - i)) - 1);
+            const __m512 factors = op(_mm512_maskz_loadu_ps(mask, outputs + i));
+            _mm512_mask_storeu_ps(gradients + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, gradients + i), factors));
+        }
+    }
+
+    struct SigmoidOp
+    {
+        KERNEL_TARGET_AVX512 __m512 operator()(__m512 x) const { return sigmoid(x); }
+    };
+
+    struct SigmoidDerivativeOp
+    {
+        KERNEL_TARGET_AVX512 __m512 operator()(__m512 x) const
+        {
+            const __m512 y = sigmoid(x);
+            return _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.0f), y));
+        }
+    };
+
+    struct SigmoidOutputDerivativeOp
+    {
+        KERNEL_TARGET_AVX512 __m512 operator()(__m512 y) const
+        {
+            return _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.0f), y));
+        }
+    };
+
+    struct ModReluOp
+    {
+        float slope;
+        KERNEL_TARGET_AVX512 __m512 operator()(__m512 x) const
+        {
+            const __m512 clamped = _mm512_min_ps(_mm512_max_ps(x, _mm512_setzero_ps()), _mm512_set1_ps(1.0f));
+            return _mm512_add_ps(clamped, _mm512_mul_ps(_mm512_set1_ps(slope), _mm512_sub_ps(x, clamped)));
+        }
+    };
+
+    struct ModReluDerivativeOp
+    {
+        float slope;
+        KERNEL_TARGET_AVX512 __m512 operator()(__m512 x) const
+        {
+            const __mmask16 inside = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GE_OQ) & _mm512_cmp_ps_mask(x, _mm512_set1_ps(1.0f), _CMP_LE_OQ);
+            return _mm512_mask_blend_ps(inside, _mm512_set1_ps(slope), _mm512_set1_ps(1.0f));
+        }
+    };
+
+    KERNEL_TARGET_AVX512 inline void sigmoid(float* values, unsigned int count)
+    {
+        transform(values, count, SigmoidOp());
+    }
+
+    KERNEL_TARGET_AVX512 inline void sigmoid_derivative(float* values, unsigned int count)
+    {
+        transform(values, count, SigmoidDerivativeOp());
+    }
+
+    KERNEL_TARGET_AVX512 inline void mod_relu(float* values, unsigned int count, float slope)
+    {
+        transform(values, count, ModReluOp{slope});
+    }
+
+    KERNEL_TARGET_AVX512 inline void mod_relu_derivative(float* values, unsigned int count, float slope)
+    {
+        transform(values, count, ModReluDerivativeOp{slope});
+    }
+
+    KERNEL_TARGET_AVX512 inline void sigmoid_backward(const float* outputs, float* gradients, unsigned int count)
+    {
+        multiply_by(outputs, gradients, count, SigmoidOutputDerivativeOp());
+    }
+
+    KERNEL_TARGET_AVX512 inline void mod_relu_backward(const float* outputs, float* gradients, unsigned int count, float slope)
+    {
+        multiply_by(outputs, gradients, count, ModReluDerivativeOp{slope});
+    }
+}
+#endif
+
+inline void sigmoid(float* values, unsigned int count)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::sigmoid(values, count);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::sigmoid(values, count);
+#endif
+        default: return scalar::sigmoid(values, count);
+    }
+}
+
+inline void sigmoid(double* values, unsigned int count)
+{
+    scalar::sigmoid(values, count);
+}
+
+inline void sigmoid_derivative(float* values, unsigned int count)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::sigmoid_derivative(values, count);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::sigmoid_derivative(values, count);
+#endif
+        default: return scalar::sigmoid_derivative(values, count);
+    }
+}
+
+inline void sigmoid_derivative(double* values, unsigned int count)
+{
+    scalar::sigmoid_derivative(values, count);
+}
+
+inline void mod_relu(float* values, unsigned int count, float slope)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::mod_relu(values, count, slope);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::mod_relu(values, count, slope);
+#endif
+        default: return scalar::mod_relu(values, count, slope);
+    }
+}
+
+inline void mod_relu(double* values, unsigned int count, double slope)
+{
+    scalar::mod_relu(values, count, slope);
+}
+
+inline void mod_relu_derivative(float* values, unsigned int count, float slope)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::mod_relu_derivative(values, count, slope);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::mod_relu_derivative(values, count, slope);
+#endif
+        default: return scalar::mod_relu_derivative(values, count, slope);
+    }
+}
+
+inline void mod_relu_derivative(double* values, unsigned int count, double slope)
+{
+    scalar::mod_relu_derivative(values, count, slope);
+}
+
+inline void sigmoid_backward(const float* outputs, float* gradients, unsigned int count)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::sigmoid_backward(outputs, gradients, count);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::sigmoid_backward(outputs, gradients, count);
+#endif
+        default: return scalar::sigmoid_backward(outputs, gradients, count);
+    }
+}
+
+inline void sigmoid_backward(const double* outputs, double* gradients, unsigned int count)
+{
+    scalar::sigmoid_backward(outputs, gradients, count);
+}
+
+inline void mod_relu_backward(const float* outputs, float* gradients, unsigned int count, float slope)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::mod_relu_backward(outputs, gradients, count, slope);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::mod_relu_backward(outputs, gradients, count, slope);
+#endif
+        default: return scalar::mod_relu_backward(outputs, gradients, count, slope);
+    }
+}
+
+inline void mod_relu_backward(const double* outputs, double* gradients, unsigned int count, double slope)
+{
+    scalar::mod_relu_backward(outputs, gradients, count, slope);
+}
+
+} // namespace kernels
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+namespace kernels
+{
+
+// Instruction sets the kernels are compiled for, in order of preference.
+enum class Isa
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+inline const char* isa_name(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Avx512: return "avx512";
+        case Isa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+inline bool isa_supported(Isa isa)
+{
+#if defined(__x86_64__) or defined(__i386__)
+    switch (isa)
+    {
+        case Isa::Avx512:
+            return __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+        case Isa::Avx2:
+            return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+        default:
+            return true;
+    }
+#else
+    return isa == Isa::Scalar;
+#endif
+}
+
+// Best instruction set of the running CPU. NEURON_DIGITS_ISA=scalar|avx2|avx512 caps the choice.
+inline Isa detect_isa()
+{
+    Isa best = Isa::Scalar;
+    if (isa_supported(Isa::Avx512))
+        best = Isa::Avx512;
+    else if (isa_supported(Isa::Avx2))
+        best = Isa::Avx2;
+
+    if (const char* forced = std::getenv("NEURON_DIGITS_ISA"))
+    {
+        for (auto isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512})
+        {
+            if (std::strcmp(forced, isa_name(isa)) == 0 and static_cast<int>(isa) < static_cast<int>(best))
+                best = isa;
+        }
+    }
+
+    return best;
+}
+
+namespace detail
+{
+    inline Isa& selected_isa()
+    {
+        static Isa isa = detect_isa();
+        return isa;
+    }
+}
+
+inline Isa active_isa()
+{
+    return detail::selected_isa();
+}
+
+// Overrides the dispatch target, mostly for tests and benchmarks comparing code paths.
+inline void set_isa(Isa isa)
+{
+    if (not isa_supported(isa))
+        throw std::runtime_error(std::string("kernels::set_isa() ") + isa_name(isa) + " is not supported by this CPU.");
+
+    detail::selected_isa() = isa;
+}
+
+} // namespace kernels
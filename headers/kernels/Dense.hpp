@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Gemm.hpp"
+
+namespace kernels
+{
+
+// Rows of a dense layer produced per step; the tile is activated while it is still in L1.
+constexpr unsigned int DENSE_TILE_ROWS = 64;
+
+// Fused dense layer forward: y = activation(W * x + bias), W is m x n with row stride ldw.
+// activation(T* values, unsigned int count) transforms a tile of y in place.
+template<typename T, typename Activation>
+inline void dense_forward(unsigned int m, unsigned int n, const T* w, std::size_t ldw, const T* x, const T* bias, T* y, Activation&& activation)
+{
+    for (unsigned int i = 0; i < m; i += DENSE_TILE_ROWS)
+    {
+        const unsigned int rows = m - i < DENSE_TILE_ROWS ? m - i : DENSE_TILE_ROWS;
+        gemv(rows, n, w + i * ldw, ldw, x, y + i, bias + i);
+        activation(y + i, rows);
+    }
+}
+
+} // namespace kernels
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+
+#include "CpuFeatures.hpp"
+#include "detail/SimdScalar.hpp"
+#include "detail/SimdAvx2.hpp"
+#include "detail/SimdAvx512.hpp"
+
+namespace kernels
+{
+
+namespace scalar
+{
+#define KERNEL_TARGET KERNEL_TARGET_SCALAR
+#include "detail/GemmImpl.inl"
+#undef KERNEL_TARGET
+} // namespace scalar
+
+#ifdef KERNEL_TARGET_AVX2
+namespace avx2
+{
+#define KERNEL_TARGET KERNEL_TARGET_AVX2
+#include "detail/GemmImpl.inl"
+#undef KERNEL_TARGET
+} // namespace avx2
+#endif
+
+#ifdef KERNEL_TARGET_AVX512
+namespace avx512
+{
+#define KERNEL_TARGET KERNEL_TARGET_AVX512
+#include "detail/GemmImpl.inl"
+#undef KERNEL_TARGET
+} // namespace avx512
+#endif
+
+// y = A * x (+ bias when given), A is m x n with row stride lda.
+template<typename T>
+inline void gemv(unsigned int m, unsigned int n, const T* a, std::size_t lda, const T* x, T* y, const T* bias = nullptr)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::gemv(m, n, a, lda, x, y, bias);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::gemv(m, n, a, lda, x, y, bias);
+#endif
+        default: return scalar::gemv(m, n, a, lda, x, y, bias);
+    }
+}
+
+// y = A * x (+ bias when given) for a compile-time M x N matrix A with row stride lda.
+// Same arithmetic as gemv, only with constant trip counts.
+template<unsigned int M, unsigned int N, typename T>
+inline void gemv_fixed(const T* a, std::size_t lda, const T* x, T* y, const T* bias = nullptr)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::gemv_sized<M, N>(M, N, a, lda, x, y, bias);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::gemv_sized<M, N>(M, N, a, lda, x, y, bias);
+#endif
+        default: return scalar::gemv_sized<M, N>(M, N, a, lda, x, y, bias);
+    }
+}
+
+// y = A^T * x without materializing the transposition, A is m x n with row stride lda.
+template<typename T>
+inline void gemv_t(unsigned int m, unsigned int n, const T* a, std::size_t lda, const T* x, T* y)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::gemv_t(m, n, a, lda, x, y);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::gemv_t(m, n, a, lda, x, y);
+#endif
+        default: return scalar::gemv_t(m, n, a, lda, x, y);
+    }
+}
+
+// A += alpha * u * v^T and, when given, bias += alpha * u; A is m x n with row stride lda.
+template<typename T>
+inline void rank1_update(unsigned int m, unsigned int n, T* a, std::size_t lda, T alpha, const T* u, const T* v, T* bias = nullptr)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::rank1_update(m, n, a, lda, alpha, u, v, bias);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::rank1_update(m, n, a, lda, alpha, u, v, bias);
+#endif
+        default: return scalar::rank1_update(m, n, a, lda, alpha, u, v, bias);
+    }
+}
+
+// C = A * B, A is m x k, B is k x n, C is m x n; all row-major with the given strides.
+template<typename T>
+inline void gemm(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::gemm(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::gemm(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+        default: return scalar::gemm(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+}
+
+// C = A^T * B without materializing the transposition, A is k x m, B is k x n, C is m x n.
+template<typename T>
+inline void gemm_tn(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_AVX512
+        case Isa::Avx512: return avx512::gemm_tn(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+#ifdef KERNEL_TARGET_AVX2
+        case Isa::Avx2: return avx2::gemm_tn(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+        default: return scalar::gemm_tn(m, n, k, a, lda, b, ldb, c, ldc);
+    }
+}
+
+} // namespace kernels
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CpuFeatures.hpp"
+
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#define KERNEL_TARGET_INT8_AVX2 __attribute__((target("avx2,fma")))
+#define KERNEL_TARGET_INT8_VNNI __attribute__((target("avx512f,avx512bw,avx512vnni,avx2,fma")))
+#endif
+
+// Integer dot products for quantized inference: y = A * x with signed 8-bit A,
+// unsigned 8-bit x and 32-bit accumulators. x values must stay within [0, 127]:
+// AVX2 maddubs adds two u8*s8 products into a saturating int16, and 7-bit
+// activations keep that sum exact, so every instruction set gives the same result.
+
+namespace kernels
+{
+
+inline bool vnni_supported()
+{
+#if defined(__x86_64__) or defined(__i386__)
+    static const bool supported = __builtin_cpu_supports("avx512vnni") and __builtin_cpu_supports("avx512bw");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+namespace scalar
+{
+    inline void gemv_u8s8(unsigned int m, unsigned int n, const std::int8_t* a, std::size_t lda, const std::uint8_t* x, std::int32_t* y)
+    {
+        for (unsigned int i = 0; i < m; i++)
+        {
+            const std::int8_t* a_row = a + i * lda;
+            std::int32_t sum = 0;
+            for (unsigned int j = 0; j < n; j++)
+            {
+                sum += static_cast<std::int32_t>(a_row[j]) * static_cast<std::int32_t>(x[j]);
+            }
+            y[i] = sum;
+        }
+    }
+}
+
+#ifdef KERNEL_TARGET_INT8_AVX2
+namespace avx2
+{
+    KERNEL_TARGET_INT8_AVX2 inline std::int32_t reduce_add_epi32(__m256i v)
+    {
+        __m128i quad = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, 0x4e));
+        quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, 0xb1));
+        return _mm_cvtsi128_si32(quad);
+    }
+
+    KERNEL_TARGET_INT8_AVX2 inline void gemv_u8s8(unsigned int m, unsigned int n, const std::int8_t* a, std::size_t lda, const std::uint8_t* x, std::int32_t* y)
+    {
+        const __m256i ones = _mm256_set1_epi16(1);
+
+        for (unsigned int i = 0; i < m; i++)
+        {
+            const std::int8_t* a_row = a + i * lda;
+            __m256i acc = _mm256_setzero_si256();
+
+            unsigned int j = 0;
+            for (; j + 32 <= n; j += 32)
+            {
+                const __m256i xv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+                const __m256i av = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_row + j));
+                // u8*s8 pairs -> int16, then pairs of int16 -> int32.
+                const __m256i pairs = _mm256_maddubs_epi16(xv, av);
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+            }
+
+            std::int32_t sum = reduce_add_epi32(acc);
+            for (; j < n; j++)
+            {
+                sum += static_cast<std::int32_t>(a_row[j]) * static_cast<std::int32_t>(x[j]);
+            }
+            y[i] = sum;
+        }
+    }
+}
+#endif
+
+#ifdef KERNEL_TARGET_INT8_VNNI
+namespace avx512
+{
+    KERNEL_TARGET_INT8_VNNI inline void gemv_u8s8(unsigned int m, unsigned int n, const std::int8_t* a, std::size_t lda, const std::uint8_t* x, std::int32_t* y)
+    {
+        for (unsigned int i = 0; i < m; i++)
+        {
+            const std::int8_t* a_row = a + i * lda;
+            __m512i acc = _mm512_setzero_si512();
+
+            unsigned int j = 0;
+            for (; j + 64 <= n; j += 64)
+            {
+                const __m512i xv = _mm512_loadu_si512(x + j);
+                const __m512i av = _mm512_loadu_si512(a_row + j);
+                // Four u8*s8 products summed straight into each int32 lane.
+                acc = _mm512_dpbusd_epi32(acc, xv, av);
+            }
+
+            std::int32_t sum = _mm512_reduce_add_epi32(acc);
+            for (; j < n; j++)
+            {
+                sum += static_cast<std::int32_t>(a_row[j]) * static_cast<std::int32_t>(x[j]);
+            }
+            y[i] = sum;
+        }
+    }
+}
+#endif
+
+// y = A * x, A is m x n int8 with row stride lda, x holds n values in [0, 127].
+inline void gemv_u8s8(unsigned int m, unsigned int n, const std::int8_t* a, std::size_t lda, const std::uint8_t* x, std::int32_t* y)
+{
+    switch (active_isa())
+    {
+#ifdef KERNEL_TARGET_INT8_VNNI
+        case Isa::Avx512:
+            if (vnni_supported())
+                return avx512::gemv_u8s8(m, n, a, lda, x, y);
+            [[fallthrough]];
+#endif
+#ifdef KERNEL_TARGET_INT8_AVX2
+        case Isa::Avx2: return avx2::gemv_u8s8(m, n, a, lda, x, y);
+#endif
+        default: return scalar::gemv_u8s8(m, n, a, lda, x, y);
+    }
+}
+
+} // namespace kernels
@@ -0,0 +1,370 @@
+// Shared GEMM/GEMV bodies. Included once per instruction set inside the matching
+// kernels::<isa> namespace, with KERNEL_TARGET and Simd<T> already defined there.
+// All matrices are row-major; lda/ldb/ldc are row strides in elements.
+
+// y = A * x (+ bias when given), A is m x n. Non-zero M and N replace m and n by
+// compile-time constants, so fixed topologies get fully unrolled loops.
+template<unsigned int M, unsigned int N, typename T>
+KERNEL_TARGET inline void gemv_sized(unsigned int m, unsigned int n, const T* a, std::size_t lda, const T* x, T* y, const T* bias)
+{
+    if constexpr (M != 0)
+        m = M;
+    if constexpr (N != 0)
+        n = N;
+
+    using S = Simd<T>;
+    constexpr unsigned int W = S::WIDTH;
+
+    // Four rows share every load of x, two accumulators per row hide the FMA latency.
+    unsigned int i = 0;
+    for (; i + 4 <= m; i += 4)
+    {
+        const T* a0 = a + i * lda;
+        const T* a1 = a0 + lda;
+        const T* a2 = a1 + lda;
+        const T* a3 = a2 + lda;
+
+        auto acc00 = S::zero(), acc01 = S::zero();
+        auto acc10 = S::zero(), acc11 = S::zero();
+        auto acc20 = S::zero(), acc21 = S::zero();
+        auto acc30 = S::zero(), acc31 = S::zero();
+
+        unsigned int j = 0;
+        for (; j + 2 * W <= n; j += 2 * W)
+        {
+            const auto x0 = S::load(x + j);
+            const auto x1 = S::load(x + j + W);
+            acc00 = S::fmadd(S::load(a0 + j), x0, acc00);
+            acc01 = S::fmadd(S::load(a0 + j + W), x1, acc01);
+            acc10 = S::fmadd(S::load(a1 + j), x0, acc10);
+            acc11 = S::fmadd(S::load(a1 + j + W), x1, acc11);
+            acc20 = S::fmadd(S::load(a2 + j), x0, acc20);
+            acc21 = S::fmadd(S::load(a2 + j + W), x1, acc21);
+            acc30 = S::fmadd(S::load(a3 + j), x0, acc30);
+            acc31 = S::fmadd(S::load(a3 + j + W), x1, acc31);
+        }
+        for (; j + W <= n; j += W)
+        {
+            const auto x0 = S::load(x + j);
+            acc00 = S::fmadd(S::load(a0 + j), x0, acc00);
+            acc10 = S::fmadd(S::load(a1 + j), x0, acc10);
+            acc20 = S::fmadd(S::load(a2 + j), x0, acc20);
+            acc30 = S::fmadd(S::load(a3 + j), x0, acc30);
+        }
+
+        T s0 = S::reduce_add(S::add(acc00, acc01));
+        T s1 = S::reduce_add(S::add(acc10, acc11));
+        T s2 = S::reduce_add(S::add(acc20, acc21));
+        T s3 = S::reduce_add(S::add(acc30, acc31));
+        for (; j < n; j++)
+        {
+            s0 += a0[j] * x[j];
+            s1 += a1[j] * x[j];
+            s2 += a2[j] * x[j];
+            s3 += a3[j] * x[j];
+        }
+
+        if (bias)
+        {
+            s0 += bias[i];
+            s1 += bias[i + 1];
+            s2 += bias[i + 2];
+            s3 += bias[i + 3];
+        }
+
+        y[i] = s0;
+        y[i + 1] = s1;
+        y[i + 2] = s2;
+        y[i + 3] = s3;
+    }
+
+    for (; i < m; i++)
+    {
+        const T* a0 = a + i * lda;
+        auto acc0 = S::zero(), acc1 = S::zero();
+
+        unsigned int j = 0;
+        for (; j + 2 * W <= n; j += 2 * W)
+        {
+            acc0 = S::fmadd(S::load(a0 + j), S::load(x + j), acc0);
+            acc1 = S::fmadd(S::load(a0 + j + W), S::load(x + j + W), acc1);
+        }
+        for (; j + W <= n; j += W)
+        {
+            acc0 = S::fmadd(S::load(a0 + j), S::load(x + j), acc0);
+        }
+
+        T s = S::reduce_add(S::add(acc0, acc1));
+        for (; j < n; j++)
+        {
+            s += a0[j] * x[j];
+        }
+        y[i] = bias ? s + bias[i] : s;
+    }
+}
+
+template<typename T>
+KERNEL_TARGET inline void gemv(unsigned int m, unsigned int n, const T* a, std::size_t lda, const T* x, T* y, const T* bias = nullptr)
+{
+    gemv_sized<0, 0>(m, n, a, lda, x, y, bias);
+}
+
+// y = A^T * x over the original row-major layout, A is m x n, x has m and y has n elements.
+template<typename T>
+KERNEL_TARGET inline void gemv_t(unsigned int m, unsigned int n, const T* a, std::size_t lda, const T* x, T* y)
+{
+    using S = Simd<T>;
+    constexpr unsigned int W = S::WIDTH;
+
+    for (unsigned int j = 0; j < n; j++)
+    {
+        y[j] = 0;
+    }
+
+    // Four rows of A are folded into y per pass, so y is loaded and stored a quarter as often.
+    unsigned int i = 0;
+    for (; i + 4 <= m; i += 4)
+    {
+        const T* a0 = a + i * lda;
+        const T* a1 = a0 + lda;
+        const T* a2 = a1 + lda;
+        const T* a3 = a2 + lda;
+        const auto x0 = S::set1(x[i]);
+        const auto x1 = S::set1(x[i + 1]);
+        const auto x2 = S::set1(x[i + 2]);
+        const auto x3 = S::set1(x[i + 3]);
+
+        unsigned int j = 0;
+        for (; j + W <= n; j += W)
+        {
+            auto acc = S::load(y + j);
+            acc = S::fmadd(S::load(a0 + j), x0, acc);
+            acc = S::fmadd(S::load(a1 + j), x1, acc);
+            acc = S::fmadd(S::load(a2 + j), x2, acc);
+            acc = S::fmadd(S::load(a3 + j), x3, acc);
+            S::store(y + j, acc);
+        }
+        for (; j < n; j++)
+        {
+            y[j] += a0[j] * x[i] + a1[j] * x[i + 1] + a2[j] * x[i + 2] + a3[j] * x[i + 3];
+        }
+    }
+
+    for (; i < m; i++)
+    {
+        const T* a0 = a + i * lda;
+        const auto x0 = S::set1(x[i]);
+
+        unsigned int j = 0;
+        for (; j + W <= n; j += W)
+        {
+            S::store(y + j, S::fmadd(S::load(a0 + j), x0, S::load(y + j)));
+        }
+        for (; j < n; j++)
+        {
+            y[j] += a0[j] * x[i];
+        }
+    }
+}
+
+// A += alpha * u * v^T and, when given, bias += alpha * u. A is m x n, u has m and v has n elements.
+template<typename T>
+KERNEL_TARGET inline void rank1_update(unsigned int m, unsigned int n, T* a, std::size_t lda, T alpha, const T* u, const T* v, T* bias = nullptr)
+{
+    using S = Simd<T>;
+    constexpr unsigned int W = S::WIDTH;
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        T* a_row = a + i * lda;
+        const T coef = alpha * u[i];
+        const auto coef_v = S::set1(coef);
+
+        unsigned int j = 0;
+        for (; j + 2 * W <= n; j += 2 * W)
+        {
+            S::store(a_row + j, S::fmadd(S::load(v + j), coef_v, S::load(a_row + j)));
+            S::store(a_row + j + W, S::fmadd(S::load(v + j + W), coef_v, S::load(a_row + j + W)));
+        }
+        for (; j + W <= n; j += W)
+        {
+            S::store(a_row + j, S::fmadd(S::load(v + j), coef_v, S::load(a_row + j)));
+        }
+        for (; j < n; j++)
+        {
+            a_row[j] += v[j] * coef;
+        }
+
+        if (bias)
+            bias[i] += coef;
+    }
+}
+
+// Register tile of the GEMM: rows of A per micro kernel call and vectors of B per row.
+constexpr unsigned int GEMM_MR = 4;
+constexpr unsigned int GEMM_NV = 2;
+
+// Element (i, p) of the left GEMM operand, stored as is or transposed.
+template<bool TransA, typename T>
+KERNEL_TARGET inline const T& gemm_a(const T* a, std::size_t lda, unsigned int i, unsigned int p)
+{
+    return TransA ? a[p * lda + i] : a[i * lda + p];
+}
+
+// C[MR x NV*W] += A[MR x k] * B[k x NV*W], the whole tile lives in registers.
+// NV = 1 serves the last vector of columns when fewer than NV*W are left.
+template<bool TransA, unsigned int NV, typename T>
+KERNEL_TARGET inline void gemm_micro(unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    using S = Simd<T>;
+    constexpr unsigned int W = S::WIDTH;
+    static_assert(NV == 1 or NV == 2, "The micro kernel covers one or two vectors per row.");
+
+    auto c00 = S::load(c), c01 = NV > 1 ? S::load(c + W) : S::zero();
+    auto c10 = S::load(c + ldc), c11 = NV > 1 ? S::load(c + ldc + W) : S::zero();
+    auto c20 = S::load(c + 2 * ldc), c21 = NV > 1 ? S::load(c + 2 * ldc + W) : S::zero();
+    auto c30 = S::load(c + 3 * ldc), c31 = NV > 1 ? S::load(c + 3 * ldc + W) : S::zero();
+
+    for (unsigned int p = 0; p < k; p++)
+    {
+        const T* b_row = b + p * ldb;
+        const auto b0 = S::load(b_row);
+        const auto b1 = NV > 1 ? S::load(b_row + W) : b0;
+
+        const auto a0 = S::set1(gemm_a<TransA>(a, lda, 0, p));
+        c00 = S::fmadd(a0, b0, c00);
+        if (NV > 1) c01 = S::fmadd(a0, b1, c01);
+        const auto a1 = S::set1(gemm_a<TransA>(a, lda, 1, p));
+        c10 = S::fmadd(a1, b0, c10);
+        if (NV > 1) c11 = S::fmadd(a1, b1, c11);
+        const auto a2 = S::set1(gemm_a<TransA>(a, lda, 2, p));
+        c20 = S::fmadd(a2, b0, c20);
+        if (NV > 1) c21 = S::fmadd(a2, b1, c21);
+        const auto a3 = S::set1(gemm_a<TransA>(a, lda, 3, p));
+        c30 = S::fmadd(a3, b0, c30);
+        if (NV > 1) c31 = S::fmadd(a3, b1, c31);
+    }
+
+    S::store(c, c00);
+    S::store(c + ldc, c10);
+    S::store(c + 2 * ldc, c20);
+    S::store(c + 3 * ldc, c30);
+    if (NV > 1)
+    {
+        S::store(c + W, c01);
+        S::store(c + ldc + W, c11);
+        S::store(c + 2 * ldc + W, c21);
+        S::store(c + 3 * ldc + W, c31);
+    }
+}
+
+// C[m x n] += A[m x k] * B[k x n] for the ragged edges the micro kernel can't cover.
+// Small batches are nothing but edge, so whole vectors of a row are still done in SIMD.
+template<bool TransA, typename T>
+KERNEL_TARGET inline void gemm_edge(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    using S = Simd<T>;
+    constexpr unsigned int W = S::WIDTH;
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        T* c_row = c + i * ldc;
+
+        unsigned int j = 0;
+        for (; j + W <= n; j += W)
+        {
+            auto acc = S::load(c_row + j);
+            for (unsigned int p = 0; p < k; p++)
+            {
+                acc = S::fmadd(S::set1(gemm_a<TransA>(a, lda, i, p)), S::load(b + p * ldb + j), acc);
+            }
+            S::store(c_row + j, acc);
+        }
+
+        for (; j < n; j++)
+        {
+            T sum = c_row[j];
+            for (unsigned int p = 0; p < k; p++)
+            {
+                sum += gemm_a<TransA>(a, lda, i, p) * b[p * ldb + j];
+            }
+            c_row[j] = sum;
+        }
+    }
+}
+
+// C = op(A) * B, op(A) is m x k, B is k x n. Blocked so a KC x NC panel of B stays
+// in L2 while MC rows of op(A) stream past it. With TransA, A is stored k x m.
+template<bool TransA, typename T>
+KERNEL_TARGET inline void gemm_blocked(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    constexpr unsigned int MR = GEMM_MR;
+    constexpr unsigned int W = Simd<T>::WIDTH;
+    constexpr unsigned int NR = GEMM_NV * W;
+    constexpr unsigned int KC = 256;
+    constexpr unsigned int MC = 64;
+    constexpr unsigned int NC = 1024;
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        T* c_row = c + i * ldc;
+        for (unsigned int j = 0; j < n; j++)
+        {
+            c_row[j] = 0;
+        }
+    }
+
+    for (unsigned int pc = 0; pc < k; pc += KC)
+    {
+        const unsigned int kb = k - pc < KC ? k - pc : KC;
+        for (unsigned int jc = 0; jc < n; jc += NC)
+        {
+            const unsigned int nb = n - jc < NC ? n - jc : NC;
+            const unsigned int nb_full = nb / NR * NR;
+            const unsigned int nb_vec = nb_full + (nb - nb_full) / W * W;
+            for (unsigned int ic = 0; ic < m; ic += MC)
+            {
+                const unsigned int mb = m - ic < MC ? m - ic : MC;
+                const unsigned int mb_full = mb / MR * MR;
+
+                const T* a_block = &gemm_a<TransA>(a, lda, ic, pc);
+                const T* b_block = b + pc * ldb + jc;
+                T* c_block = c + ic * ldc + jc;
+
+                for (unsigned int jr = 0; jr < nb_full; jr += NR)
+                {
+                    for (unsigned int ir = 0; ir < mb_full; ir += MR)
+                    {
+                        gemm_micro<TransA, GEMM_NV>(kb, &gemm_a<TransA>(a_block, lda, ir, 0), lda, b_block + jr, ldb, c_block + ir * ldc + jr, ldc);
+                    }
+                }
+                for (unsigned int jr = nb_full; jr < nb_vec; jr += W)
+                {
+                    for (unsigned int ir = 0; ir < mb_full; ir += MR)
+                    {
+                        gemm_micro<TransA, 1>(kb, &gemm_a<TransA>(a_block, lda, ir, 0), lda, b_block + jr, ldb, c_block + ir * ldc + jr, ldc);
+                    }
+                }
+
+                if (mb_full < mb)
+                    gemm_edge<TransA>(mb - mb_full, nb_vec, kb, &gemm_a<TransA>(a_block, lda, mb_full, 0), lda, b_block, ldb, c_block + mb_full * ldc, ldc);
+                if (nb_vec < nb)
+                    gemm_edge<TransA>(mb, nb - nb_vec, kb, a_block, lda, b_block + nb_vec, ldb, c_block + nb_vec, ldc);
+            }
+        }
+    }
+}
+
+// C = A * B, A is m x k, B is k x n.
+template<typename T>
+KERNEL_TARGET inline void gemm(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    gemm_blocked<false>(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+// C = A^T * B, A is k x m, B is k x n.
+template<typename T>
+KERNEL_TARGET inline void gemm_tn(unsigned int m, unsigned int n, unsigned int k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    gemm_blocked<true>(m, n, k, a, lda, b, ldb, c, ldc);
+}
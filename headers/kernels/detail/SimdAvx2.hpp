@@ -0,0 +1,63 @@
+#pragma once
+
+#if defined(__x86_64__) or defined(__i386__)
+
+#include <immintrin.h>
+
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+namespace kernels
+{
+namespace avx2
+{
+
+template<typename T>
+struct Simd;
+
+template<>
+struct Simd<double>
+{
+    using Vec = __m256d;
+    static constexpr unsigned int WIDTH = 4;
+
+    KERNEL_TARGET_AVX2 static Vec zero() { return _mm256_setzero_pd(); }
+    KERNEL_TARGET_AVX2 static Vec set1(double x) { return _mm256_set1_pd(x); }
+    KERNEL_TARGET_AVX2 static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+    KERNEL_TARGET_AVX2 static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+    KERNEL_TARGET_AVX2 static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    KERNEL_TARGET_AVX2 static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    KERNEL_TARGET_AVX2 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(a, b, c); }
+
+    KERNEL_TARGET_AVX2 static double reduce_add(Vec v)
+    {
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+};
+
+template<>
+struct Simd<float>
+{
+    using Vec = __m256;
+    static constexpr unsigned int WIDTH = 8;
+
+    KERNEL_TARGET_AVX2 static Vec zero() { return _mm256_setzero_ps(); }
+    KERNEL_TARGET_AVX2 static Vec set1(float x) { return _mm256_set1_ps(x); }
+    KERNEL_TARGET_AVX2 static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+    KERNEL_TARGET_AVX2 static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+    KERNEL_TARGET_AVX2 static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+    KERNEL_TARGET_AVX2 static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+    KERNEL_TARGET_AVX2 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+
+    KERNEL_TARGET_AVX2 static float reduce_add(Vec v)
+    {
+        __m128 quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+        return _mm_cvtss_f32(_mm_add_ss(quad, _mm_movehdup_ps(quad)));
+    }
+};
+
+} // namespace avx2
+} // namespace kernels
+
+#endif
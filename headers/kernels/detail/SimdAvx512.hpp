@@ -0,0 +1,53 @@
+#pragma once
+
+#if defined(__x86_64__) or defined(__i386__)
+
+#include <immintrin.h>
+
+#define KERNEL_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+namespace kernels
+{
+namespace avx512
+{
+
+template<typename T>
+struct Simd;
+
+template<>
+struct Simd<double>
+{
+    using Vec = __m512d;
+    static constexpr unsigned int WIDTH = 8;
+
+    KERNEL_TARGET_AVX512 static Vec zero() { return _mm512_setzero_pd(); }
+    KERNEL_TARGET_AVX512 static Vec set1(double x) { return _mm512_set1_pd(x); }
+    KERNEL_TARGET_AVX512 static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+    KERNEL_TARGET_AVX512 static void store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+    KERNEL_TARGET_AVX512 static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+    KERNEL_TARGET_AVX512 static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+    KERNEL_TARGET_AVX512 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(a, b, c); }
+
+    KERNEL_TARGET_AVX512 static double reduce_add(Vec v) { return _mm512_reduce_add_pd(v); }
+};
+
+template<>
+struct Simd<float>
+{
+    using Vec = __m512;
+    static constexpr unsigned int WIDTH = 16;
+
+    KERNEL_TARGET_AVX512 static Vec zero() { return _mm512_setzero_ps(); }
+    KERNEL_TARGET_AVX512 static Vec set1(float x) { return _mm512_set1_ps(x); }
+    KERNEL_TARGET_AVX512 static Vec load(const float* p) { return _mm512_loadu_ps(p); }
+    KERNEL_TARGET_AVX512 static void store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+    KERNEL_TARGET_AVX512 static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+    KERNEL_TARGET_AVX512 static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+    KERNEL_TARGET_AVX512 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_ps(a, b, c); }
+    KERNEL_TARGET_AVX512 static float reduce_add(Vec v) { return _mm512_reduce_add_ps(v); }
+};
+
+} // namespace avx512
+} // namespace kernels
+
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#define KERNEL_TARGET_SCALAR
+
+namespace kernels
+{
+namespace scalar
+{
+
+// Portable fallback: a "vector" of a single lane, so the shared kernel bodies
+// compile unchanged and the compiler is free to autovectorize them.
+template<typename T>
+struct Simd
+{
+    using Vec = T;
+    static constexpr unsigned int WIDTH = 1;
+
+    static Vec zero() { return 0; }
+    static Vec set1(T x) { return x; }
+    static Vec load(const T* p) { return *p; }
+    static void store(T* p, Vec v) { *p = v; }
+    static Vec add(Vec a, Vec b) { return a + b; }
+    static Vec mul(Vec a, Vec b) { return a * b; }
+    static Vec fmadd(Vec a, Vec b, Vec c) { return a * b + c; }
+    static T reduce_add(Vec v) { return v; }
+};
+
+} // namespace scalar
+} // namespace kernels
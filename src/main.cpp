@@ -1,4 +1,6 @@
+#ifdef NEURON_DIGITS_GUI
 #include <GL/glut.h>
+#endif
 #include <thread>
 #include <iostream>
 #include <chrono>
@@ -8,14 +10,28 @@
 #include <chrono>
 #include <utility>
 #include <cmath>
+#include <algorithm>
 
+#ifdef NEURON_DIGITS_GUI
 #include "RenderWindow.hpp"
 #include "BitMap.hpp"
+#endif
+#include "CommandLine.hpp"
+#include "LatencyHistogram.hpp"
 #include "Matrix.hpp"
 #include "NeuroNet.hpp"
+#include "Evaluator.hpp"
+#include "ParallelTrainer.hpp"
+#include "HogwildTrainer.hpp"
+#include "Dataset.hpp"
+#include "BinaryDataset.hpp"
+#include "IdxDataset.hpp"
+#include "DatasetStream.hpp"
+#include "kernels/CpuFeatures.hpp"
 #include "activators/ModReluFunc.hpp"
 #include "activators/SigmoidFunc.hpp"
 
+#ifdef NEURON_DIGITS_GUI
 const unsigned int WINDOW_WIDTH = 800;
 const unsigned int WINDOW_HEIGHT = 560;
 const unsigned int BLOCK_SIZE = 20;
@@ -25,57 +41,78 @@ const auto COLUMNS = 28; // WINDOW_WIDTH / BLOCK_SIZE;
 bool isMousePressed = false;
 
 std::shared_ptr<RenderWindow> window;
+#endif
 
-void teach(std::shared_ptr<NeuroNet> neuroNet, unsigned int epoches, double percentToEnd = 0.97)
+// batch_size 1 trains per sample and only on mistakes, larger batches train on
+// every sample through NeuroNet::train_batch(), split across threads when more than one.
+template<typename Data>
+void teach(std::shared_ptr<NeuroNet> neuroNet, const Data& teach_data, unsigned int epoches, unsigned int batch_size = 1, unsigned int threads = 1, double percentToEnd = 0.97)
 {
-    std::ifstream input("lib_10k.txt");
-
-    std::vector<std::pair<int, std::vector<double>>> teach_data;
-    while(not input.eof())
-    {
-        int rightAnswer;
-        std::vector<double> input_data;
-        input_data.resize(784);
-
-        input >> rightAnswer;
-        for (int i = 0; i < 784; i++)
-        {
-            input >> input_data[i];
-        }
-
-        teach_data.push_back({rightAnswer, input_data});
-    }
     std::cout << "Teaching data was read, starting learning process..." << std::endl;
 
     int good = 0;
     int total = 0;
+    std::size_t processed = 0;
     auto start_point = std::chrono::system_clock::now();
     double rate = 0;
 
+    std::vector<int> batch_labels;
+    std::vector<SampleView> batch_inputs;
+    std::unique_ptr<ParallelTrainer> trainer;
+    if (batch_size > 1 and threads > 1)
+        trainer = std::make_unique<ParallelTrainer>(*neuroNet, threads);
+
     int learn_data_iterator = 0;
     double epoch = 0;
     while (epoch < epoches and rate < percentToEnd)
     {
-        const auto& data = teach_data.at(learn_data_iterator);
-        learn_data_iterator++;
-        learn_data_iterator = learn_data_iterator < teach_data.size() ? learn_data_iterator : 0;
+        const double study_coef = 0.15 * exp(-epoch / static_cast<double>(epoches));
 
+        if (batch_size > 1)
+        {
+            batch_labels.clear();
+            batch_inputs.clear();
+            for (unsigned int b = 0; b < batch_size; b++)
+            {
+                decltype(auto) data = teach_data.at(learn_data_iterator);
+                learn_data_iterator++;
+                learn_data_iterator = learn_data_iterator < teach_data.size() ? learn_data_iterator : 0;
 
-        const auto answer = neuroNet->analyze(data.second);
+                batch_labels.push_back(data.first);
+                batch_inputs.push_back(view_of(data.second));
+            }
 
-        if (answer == data.first)
-        {
-            good++;
+            if (trainer)
+                good += trainer->train_batch(batch_labels, batch_inputs, study_coef);
+            else
+                good += neuroNet->train_batch(batch_labels, batch_inputs, study_coef);
+            total += batch_size;
+            processed += batch_size;
         }
         else
         {
-            neuroNet->back_propagate(data.first, 0.15 * exp(-epoch / static_cast<double>(epoches)));
+            decltype(auto) data = teach_data.at(learn_data_iterator);
+            learn_data_iterator++;
+            learn_data_iterator = learn_data_iterator < teach_data.size() ? learn_data_iterator : 0;
+
+
+            const auto answer = neuroNet->analyze(data.second);
+
+            if (answer == data.first)
+            {
+                good++;
+            }
+            else
+            {
+                neuroNet->back_propagate(data.first, study_coef);
+            }
+            total++;
+            processed++;
         }
-        total++;
 
         rate = good / static_cast<double>(total);
 
-        if (total % 10000 == 0)
+        if (total >= 10000)
         {
             auto point_diff = std::chrono::system_clock::now() - start_point;
             auto time_spent_s = std::chrono::duration_cast<std::chrono::seconds>(point_diff);
@@ -87,9 +124,342 @@ void teach(std::shared_ptr<NeuroNet> neuroNet, unsigned int epoches, double perc
         }
     }
 
-    std::cout << "Teaching ended." << std::endl;
+    const std::chrono::duration<double> seconds = std::chrono::system_clock::now() - start_point;
+    std::cout << "Teaching ended. " << processed << " samples in " << seconds.count() << "s (" << processed / seconds.count() << " samples/s)." << std::endl;
+}
+
+// Trains pass after pass over a file streamed from disk, so only a few chunks of
+// it are in memory at once. Same per-sample and mini-batch rules as teach().
+// Returns how many samples were trained on over all epoches.
+std::size_t teach_streamed(std::shared_ptr<NeuroNet> neuroNet, const std::string& filename, unsigned int epoches, unsigned int batch_size = 1, unsigned int threads = 1)
+{
+    // Whole batches per chunk, none straddles two of them.
+    const std::size_t chunk_size = std::max<std::size_t>(1024 / batch_size, 1) * batch_size;
+    DatasetStream stream(open_chunk_reader(filename), chunk_size);
+    std::cout << "Streaming \"" << filename << "\" in chunks of " << chunk_size << " samples, starting learning process..." << std::endl;
+
+    std::vector<int> batch_labels;
+    std::vector<SampleView> batch_inputs;
+    std::unique_ptr<ParallelTrainer> trainer;
+    if (batch_size > 1 and threads > 1)
+        trainer = std::make_unique<ParallelTrainer>(*neuroNet, threads);
+
+    const auto start_point = std::chrono::steady_clock::now();
+    for (unsigned int epoch = 0; epoch < epoches; epoch++)
+    {
+        const double study_coef = 0.15 * exp(-epoch / static_cast<double>(epoches));
+        std::size_t good = 0;
+        std::size_t total = 0;
+
+        while (const SampleChunk* chunk = stream.next())
+        {
+            if (batch_size > 1)
+            {
+                for (std::size_t first = 0; first < chunk->size(); first += batch_size)
+                {
+                    batch_labels.clear();
+                    batch_inputs.clear();
+                    for (std::size_t i = first; i < std::min(first + batch_size, chunk->size()); i++)
+                    {
+                        const auto data = (*chunk)[i];
+                        batch_labels.push_back(data.first);
+                        batch_inputs.push_back(data.second);
+                    }
+
+                    if (trainer)
+                        good += trainer->train_batch(batch_labels, batch_inputs, study_coef);
+                    else
+                        good += neuroNet->train_batch(batch_labels, batch_inputs, study_coef);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < chunk->size(); i++)
+                {
+                    const auto data = (*chunk)[i];
+                    if (neuroNet->analyze(data.second) == data.first)
+                        good++;
+                    else
+                        neuroNet->back_propagate(data.first, study_coef);
+                }
+            }
+            total += chunk->size();
+        }
+
+        std::cout << "Epoch: " << epoch << "; Good: " << good << "; Total: " << total << "; Rate: " << good / static_cast<double>(std::max<std::size_t>(total, 1)) << ";" << std::endl;
+    }
+
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start_point;
+    const auto stats = stream.stats();
+    std::cout << "Teaching ended. " << stats.samples << " samples in " << seconds.count() << "s (" << stats.samples / seconds.count() << " samples/s); "
+              << "reading took " << stats.read_seconds << "s in the background, training waited " << stats.stall_seconds << "s for it." << std::endl;
+    return stats.samples;
 }
 
+// Lock-free asynchronous training: threads update the shared weights without synchronisation.
+template<typename Data>
+void teach_hogwild(std::shared_ptr<NeuroNet> neuroNet, const Data& teach_data, unsigned int epoches, unsigned int threads)
+{
+    std::cout << "Teaching data was read, starting asynchronous learning on " << threads << " threads..." << std::endl;
+
+    HogwildTrainer trainer(*neuroNet, threads);
+    const auto report = trainer.train(teach_data, epoches, 0.05);
+
+    int good = 0;
+    for (std::size_t i = 0; i < teach_data.size(); i++)
+    {
+        decltype(auto) data = teach_data[i];
+        if (neuroNet->analyze(data.second) == data.first)
+            good++;
+    }
+
+    std::cout << "Teaching ended. " << report.samples << " samples in " << report.seconds << "s (" << report.samples_per_second << " samples/s); "
+              << "Last epoch rate: " << report.last_epoch_accuracy << "; Final rate: " << good / static_cast<double>(teach_data.size()) << ";" << std::endl;
+}
+
+// Passes the dataset in filename to callback: an MNIST IDX images file (with its
+// labels file next to it), a binary dataset made by neuron_digits-convert-dataset
+// or a text one.
+template<typename Callback>
+void with_dataset(const std::string& filename, Callback&& callback)
+{
+    if (filename.find("images-idx3") != std::string::npos)
+        callback(IdxDataset(filename));
+    else if (is_binary_dataset(filename))
+        callback(BinaryDataset(filename));
+    else
+        callback(read_text_dataset(filename));
+}
+
+// The upstream MNIST training set when its IDX files are in the working directory,
+// then the mapped binary copy, then the text file.
+std::string default_teach_file()
+{
+    if (std::ifstream("train-images-idx3-ubyte"))
+        return "train-images-idx3-ubyte";
+    return std::ifstream("lib_10k.bin") ? "lib_10k.bin" : "lib_10k.txt";
+}
+
+// The MNIST test set when it is there, the teaching data otherwise.
+std::string default_eval_file()
+{
+    return std::ifstream("t10k-images-idx3-ubyte") ? "t10k-images-idx3-ubyte" : default_teach_file();
+}
+
+// weights.bin maps in without parsing, weights.txt is kept for older builds.
+std::string default_weights_file()
+{
+    return std::ifstream("weights.bin") ? "weights.bin" : "weights.txt";
+}
+
+template<typename Callback>
+void with_teach_data(Callback&& callback)
+{
+    with_dataset(default_teach_file(), callback);
+}
+
+void print_report(const Evaluator::Report& report, unsigned int batch_size, const LatencyHistogram& latency)
+{
+    std::cout << report.samples << " samples in " << report.seconds << "s (" << report.samples_per_second << " samples/s); "
+              << "latency of a batch of " << batch_size << ": p50 " << latency.percentile(0.5) * 1e6 << "us, p90 "
+              << latency.percentile(0.9) * 1e6 << "us, p99 " << latency.percentile(0.99) * 1e6 << "us; "
+              << "Rate: " << report.accuracy() << "; Top " << report.top_k << " rate: " << report.top_k_accuracy() << ";" << std::endl;
+    if (report.invalid > 0)
+        std::cout << report.invalid << " samples got no answer (NaN outputs) and count as wrong." << std::endl;
+}
+
+// Rows are labels and columns answers, followed by the recall and precision of every label.
+void print_confusion(const Evaluator::Report& report)
+{
+    std::cout << "label";
+    for (unsigned int answer = 0; answer < report.classes; answer++)
+    {
+        std::cout << "\t" << answer;
+    }
+    std::cout << "\trecall\tprecision" << std::endl;
+
+    for (unsigned int label = 0; label < report.classes; label++)
+    {
+        std::cout << label;
+        for (unsigned int answer = 0; answer < report.classes; answer++)
+        {
+            std::cout << "\t" << report.count(label, answer);
+        }
+        std::cout << "\t" << report.recall(label) << "\t" << report.precision(label) << std::endl;
+    }
+}
+
+std::shared_ptr<IActivatorFunc> make_activator(const std::string& name)
+{
+    if (name == "sigmoid")
+        return std::make_shared<SigmoidFunc>();
+    if (name == "modrelu")
+        return std::make_shared<ModReluFunc>();
+    throw std::runtime_error("Unknown activator func \"" + name + "\".");
+}
+
+unsigned int threads_flag(const CommandLine& line)
+{
+    const unsigned int threads = line.unsigned_value("threads", 1);
+    return threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void save_weights_file(NeuroNet& neuroNet, const std::string& filename)
+{
+    const bool binary = filename.size() >= 4 and filename.compare(filename.size() - 4, 4, ".bin") == 0;
+    if (binary)
+        neuroNet.save_weights_binary(filename);
+    else
+        neuroNet.save_weights(filename);
+}
+
+void print_usage(const char* program)
+{
+    std::cout << "usage: " << program << "                  interactive teaching, then the drawing window" << std::endl
+              << "       " << program << " train [--data <file>] [--weights <file>] [--resume] [--hidden <size>] [--epochs <count>]" << std::endl
+              << "                    [--mode sample|batch|hogwild|stream] [--batch <size>] [--threads <count>] [--activator sigmoid|modrelu]" << std::endl
+              << "       " << program << " eval [--data <file>] [--weights <file>] [--batch <size>] [--threads <count>] [--top <k>] [--activator sigmoid|modrelu]" << std::endl
+              << "       " << program << " bench [--data <file>] [--weights <file>] [--batch <size>] [--threads <count>] [--top <k>] [--seconds <time>] [--activator sigmoid|modrelu]" << std::endl
+              << "--data takes an MNIST *-images-idx3-ubyte file, a binary or a text dataset. --threads 0 uses every core." << std::endl
+              << "NEURON_DIGITS_ISA=scalar|avx2|avx512 caps the instruction set of the kernels." << std::endl;
+}
+
+// Teaches a new network, or the one in --weights with --resume, and saves it to
+// --weights: binary when the name ends in .bin, text otherwise.
+int run_train(const CommandLine& line)
+{
+    line.check_flags({"data", "weights", "resume", "hidden", "epochs", "mode", "batch", "threads", "activator"});
+    const auto activator = make_activator(line.value("activator", "sigmoid"));
+    const std::string weights_file = line.value("weights", "weights.bin");
+    const std::string data_file = line.value("data", default_teach_file());
+    const unsigned int epoches = line.unsigned_value("epochs", 10);
+    const unsigned int batch_size = std::max(1u, line.unsigned_value("batch", 1));
+    const unsigned int threads = threads_flag(line);
+    const std::string mode = line.value("mode", batch_size > 1 ? "batch" : "sample");
+    if (mode != "sample" and mode != "batch" and mode != "hogwild" and mode != "stream")
+        throw std::runtime_error("Unknown teaching mode \"" + mode + "\".");
+
+    std::shared_ptr<NeuroNet> neuroNet;
+    if (line.has("resume"))
+    {
+        neuroNet = std::make_shared<NeuroNet>(std::vector<unsigned int>{784, 256, 10}, activator);
+        neuroNet->read_weights(weights_file);
+    }
+    else
+    {
+        neuroNet = std::make_shared<NeuroNet>(std::vector<unsigned int>{784, line.unsigned_value("hidden", 256), 10}, activator);
+    }
+
+    std::size_t trained = 0;
+    if (mode == "stream")
+    {
+        trained = teach_streamed(neuroNet, data_file, epoches, batch_size, threads);
+    }
+    else
+    {
+        with_dataset(data_file, [&](const auto& teach_data) {
+            trained = teach_data.size() * epoches;
+            if (mode == "hogwild")
+                teach_hogwild(neuroNet, teach_data, epoches, threads);
+            else if (mode == "batch")
+                teach(neuroNet, teach_data, epoches, batch_size, threads);
+            else
+                teach(neuroNet, teach_data, epoches);
+        });
+    }
+
+    // Weights that saw no sample aren't worth replacing the saved ones with.
+    if (trained == 0)
+        throw std::runtime_error("No samples were trained on from \"" + data_file + "\", \"" + weights_file + "\" is left as it was.");
+
+    save_weights_file(*neuroNet, weights_file);
+    std::cout << "Weights saved to \"" << weights_file << "\"." << std::endl;
+    return 0;
+}
+
+// eval makes one pass over the data and prints the confusion matrix. bench makes one untimed pass, then passes until
+// --seconds are up, for throughput and latency figures steady enough to compare
+// between builds and machines.
+int run_eval(const CommandLine& line, bool bench)
+{
+    if (bench)
+        line.check_flags({"data", "weights", "batch", "threads", "top", "seconds", "activator"});
+    else
+        line.check_flags({"data", "weights", "batch", "threads", "top", "activator"});
+
+    const auto activator = make_activator(line.value("activator", "sigmoid"));
+    const std::string weights_file = line.value("weights", default_weights_file());
+    const std::string data_file = line.value("data", default_eval_file());
+    const unsigned int batch_size = std::max(1u, line.unsigned_value("batch", 256));
+    const unsigned int top_k = std::max(1u, line.unsigned_value("top", 5));
+    const unsigned int threads = threads_flag(line);
+    const double seconds = line.double_value("seconds", 5);
+
+    NeuroNet neuroNet({1, 1}, activator);
+    neuroNet.read_weights(weights_file);
+
+    with_dataset(data_file, [&](const auto& data) {
+        if (data.size() == 0)
+            throw std::runtime_error("\"" + data_file + "\" holds no samples.");
+
+        Evaluator evaluator(threads, batch_size, top_k);
+        LatencyHistogram latency;
+        std::cout << "Network " << weights_file << " on " << data_file << ": " << data.size() << " samples, batches of " << batch_size
+                  << ", " << threads << " threads, " << kernels::isa_name(kernels::active_isa()) << " kernels." << std::endl;
+
+        if (not bench)
+        {
+            const auto report = evaluator.evaluate(neuroNet, data, &latency);
+            print_report(report, batch_size, latency);
+            print_confusion(report);
+            return;
+        }
+
+        evaluator.evaluate(neuroNet, data);
+
+        Evaluator::Report total;
+        unsigned int passes = 0;
+        while (passes == 0 or total.seconds < seconds)
+        {
+            const auto pass = evaluator.evaluate(neuroNet, data, &latency);
+            total.samples += pass.samples;
+            total.seconds += pass.seconds;
+            total.top_k = pass.top_k;
+            total.correct += pass.correct;
+            total.top_k_correct += pass.top_k_correct;
+            total.invalid += pass.invalid;
+            passes++;
+        }
+        total.samples_per_second = total.samples / total.seconds;
+        std::cout << passes << " passes: ";
+        print_report(total, batch_size, latency);
+    });
+    return 0;
+}
+
+int run_command(int argc, char** argv)
+{
+    try
+    {
+        const CommandLine line(argc, argv);
+        if (line.command() == "train")
+            return run_train(line);
+        if (line.command() == "eval")
+            return run_eval(line, false);
+        if (line.command() == "bench")
+            return run_eval(line, true);
+
+        print_usage(argv[0]);
+        return line.command() == "help" or line.command() == "--help" ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
+
+#ifdef NEURON_DIGITS_GUI
 void main_loop(int)
 {
     if (window)
@@ -97,9 +467,13 @@ void main_loop(int)
 
     glutTimerFunc(1, main_loop, 0);
 }
+#endif
 
 int main(int argc, char** argv)
 {
+    if (argc > 1)
+        return run_command(argc, argv);
+
     std::shared_ptr<IActivatorFunc> activator;
     std::shared_ptr<NeuroNet> neuroNet;
     int in = 0;
@@ -127,7 +501,8 @@ int main(int argc, char** argv)
             throw std::runtime_error("Unknown activator func.");
     }
 
-    std::cout << "Read weights from \"weights.txt\"?" << std::endl;
+    const std::string weights_file = default_weights_file();
+    std::cout << "Read weights from \"" << weights_file << "\"?" << std::endl;
     std::cout << "1. Yes" << std::endl;
     std::cout << "2. No" << std::endl;
     in = 0;
@@ -142,7 +517,7 @@ int main(int argc, char** argv)
     if (in == 1)
     {
         neuroNet = std::make_shared<NeuroNet>(std::vector<unsigned int>{784, 256, 10}, activator);
-        neuroNet->read_weights("weights.txt");
+        neuroNet->read_weights(weights_file);
     }
     else 
     {
@@ -151,7 +526,7 @@ int main(int argc, char** argv)
         neuroNet = std::make_shared<NeuroNet>(std::vector<unsigned int>{784, static_cast<unsigned int>(in), 10}, activator);
     }
 
-    std::cout << "Teach neuronet from  \"lib_10k.txt\"?" << std::endl;
+    std::cout << "Teach neuronet from  \"" << default_teach_file() << "\"?" << std::endl;
     std::cout << "1. Yes" << std::endl;
     std::cout << "2. No" << std::endl;
     in = 0;
@@ -169,8 +544,62 @@ int main(int argc, char** argv)
         {
             std::cout << "Input teaching epoches count:" << std::endl;
             std::cin >> in;
-            teach(neuroNet, in);
-            neuroNet->save_weights("weights.txt");
+            const unsigned int epoches = in;
+            std::cout << "Teaching mode:" << std::endl;
+            std::cout << "1. Sample by sample" << std::endl;
+            std::cout << "2. Mini-batches" << std::endl;
+            std::cout << "3. Asynchronous (Hogwild!)" << std::endl;
+            std::cout << "4. Mini-batches streamed from disk" << std::endl;
+            in = 0;
+            while (in < 1 or in > 4)
+            {
+                std::cin >> in;
+                if (in < 1 or in > 4)
+                {
+                    std::cout << "Incorrect input! Try again." << std::endl;
+                }
+            }
+            const int mode = in;
+
+            unsigned int batch_size = 1;
+            if (mode == 2 or mode == 4)
+            {
+                std::cout << "Input batch size:" << std::endl;
+                std::cin >> in;
+                batch_size = std::max(in, 1);
+            }
+            unsigned int threads = 1;
+            if (mode != 1)
+            {
+                std::cout << "Input teaching threads count (0 to use every core):" << std::endl;
+                std::cin >> in;
+                threads = in > 0 ? in : std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            std::size_t trained = 0;
+            if (mode == 4)
+            {
+                trained = teach_streamed(neuroNet, default_teach_file(), epoches, batch_size, threads);
+            }
+            else
+            {
+                with_teach_data([&](const auto& teach_data) {
+                    trained = teach_data.size() * epoches;
+                    if (mode == 3)
+                        teach_hogwild(neuroNet, teach_data, epoches, threads);
+                    else
+                        teach(neuroNet, teach_data, epoches, batch_size, threads);
+                });
+            }
+            if (trained == 0)
+            {
+                std::cout << "No samples were trained on, the saved weights are left as they were." << std::endl;
+            }
+            else
+            {
+                neuroNet->save_weights("weights.txt");
+                neuroNet->save_weights_binary("weights.bin");
+            }
             std::cout << "Repeat?" << std::endl;
             std::cout << "1. Yes" << std::endl;
             std::cout << "2. No" << std::endl;
@@ -188,6 +617,7 @@ int main(int argc, char** argv)
         }
     }
 
+#ifdef NEURON_DIGITS_GUI
     std::shared_ptr<BitMap> bitMap = std::make_shared<BitMap>(ROWS, COLUMNS, BLOCK_SIZE);
     window = std::make_shared<RenderWindow>(WINDOW_WIDTH, WINDOW_HEIGHT, "Neuron");
     window->init();
@@ -251,6 +681,9 @@ int main(int argc, char** argv)
     glutTimerFunc(1, main_loop, 0);
 
     window->start();
+#else
+    std::cout << "Built without the drawing window, see \"" << argv[0] << " help\" for the headless commands." << std::endl;
+#endif
 
     return 0;
 }
\ No newline at end of file
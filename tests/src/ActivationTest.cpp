@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "kernels/Activation.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+#include "TestHelpers.hpp"
+
+namespace
+{
+    // Every float in [-100, 100] at a spacing that hits both tails and the
+    // range reduction boundaries, plus the values ModRelu switches at.
+    std::vector<float> activation_inputs()
+    {
+        std::vector<float> result = {0.0f, -0.0f, 1.0f, std::nextafter(1.0f, 2.0f), std::nextafter(0.0f, -1.0f), -87.5f, 88.5f, -1000.0f, 1000.0f};
+        for (float x = -100; x <= 100; x += 0.00731f)
+        {
+            result.push_back(x);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("Vectorised activations stay within their documented error on every instruction set")
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const auto inputs = activation_inputs();
+    // Odd length, so every kernel runs its tail too.
+    const unsigned int count = inputs.size() | 1u;
+
+    SECTION("sigmoid")
+    {
+        auto values = inputs;
+        values.resize(count);
+        kernels::sigmoid(values.data(), count);
+        for (unsigned int i = 0; i < inputs.size(); i++)
+        {
+            const double exact = 1 / (1 + std::exp(-static_cast<double>(inputs[i])));
+            REQUIRE(std::abs(values[i] - exact) < 1.2e-7);
+        }
+    }
+    SECTION("sigmoid derivative")
+    {
+        auto values = inputs;
+        values.resize(count);
+        kernels::sigmoid_derivative(values.data(), count);
+        for (unsigned int i = 0; i < inputs.size(); i++)
+        {
+            const double y = 1 / (1 + std::exp(-static_cast<double>(inputs[i])));
+            REQUIRE(std::abs(values[i] - y * (1 - y)) < 1.5e-7);
+        }
+    }
+    SECTION("exp")
+    {
+        for (const float x : inputs)
+        {
+            if (x < -87 or x > 88)
+                continue;
+            const double exact = std::exp(static_cast<double>(x));
+            REQUIRE(std::abs(kernels::scalar::exp_approx(x) - exact) <= 2.5e-7 * exact);
+        }
+    }
+    SECTION("ModRelu gives the bits of the branching definition")
+    {
+        ModReluFunc reference;
+        auto values = inputs;
+        values.resize(count);
+        kernels::mod_relu(values.data(), count, 0.01f);
+        auto derivatives = inputs;
+        derivatives.resize(count);
+        kernels::mod_relu_derivative(derivatives.data(), count, 0.01f);
+        for (unsigned int i = 0; i < inputs.size(); i++)
+        {
+            REQUIRE(values[i] == reference.func(inputs[i]));
+            REQUIRE(derivatives[i] == reference.derivative_func(inputs[i]));
+        }
+    }
+}
+
+TEST_CASE("Backward kernels take the derivative from the activations")
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    SigmoidFunc sigmoid;
+    ModReluFunc mod_relu;
+    const auto inputs = activation_inputs();
+    const unsigned int count = inputs.size() | 1u;
+
+    for (IActivatorFunc* activator : {static_cast<IActivatorFunc*>(&sigmoid), static_cast<IActivatorFunc*>(&mod_relu)})
+    {
+        auto outputs = inputs;
+        outputs.resize(count);
+        activator->func_inplace(outputs.data(), count);
+
+        std::vector<float> gradients(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            gradients[i] = 1 - (i % 7) * 0.3f;
+        }
+        const auto upstream = gradients;
+        activator->backward_inplace(outputs.data(), gradients.data(), count);
+
+        for (unsigned int i = 0; i < inputs.size(); i++)
+        {
+            REQUIRE(gradients[i] == upstream[i] * activator->derivative_from_output(outputs[i]));
+            // ModRelu's kinks: a step off them may round right onto them.
+            if (outputs[i] == 0 or outputs[i] == 1)
+                continue;
+            REQUIRE(std::abs(activator->derivative_from_output(outputs[i]) - activator->derivative_func(inputs[i])) < 2.5e-7f);
+        }
+    }
+}
+
+TEST_CASE("Activator Matrix overloads leave the row padding zero")
+{
+    SigmoidFunc sigmoid;
+    ModReluFunc mod_relu;
+
+    MatrixF x(3, 5);
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int j = 0; j < 5; j++)
+        {
+            x(i, j) = i * 0.7f - j * 0.4f;
+        }
+    }
+
+    for (IActivatorFunc* activator : {static_cast<IActivatorFunc*>(&sigmoid), static_cast<IActivatorFunc*>(&mod_relu)})
+    {
+        const auto values = activator->func(x);
+        auto derivatives = x;
+        activator->derivative_inplace(derivatives);
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            for (unsigned int j = 0; j < 5; j++)
+            {
+                REQUIRE(std::abs(values(i, j) - activator->func(x(i, j))) < 1.2e-7f);
+                REQUIRE(std::abs(derivatives(i, j) - activator->derivative_func(x(i, j))) < 1.5e-7f);
+            }
+            for (unsigned int j = 5; j < x.stride(); j++)
+            {
+                REQUIRE(values.row(i)[j] == 0);
+                REQUIRE(derivatives.row(i)[j] == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "BinaryDataset.hpp"
+#include "DatasetStream.hpp"
+#include "NeuroNet.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    // Pixels are k / 255 like the MNIST derived data, so uint8 storage is exact.
+    Dataset byte_valued_dataset(std::size_t count)
+    {
+        Dataset result;
+        for (std::size_t sample = 0; sample < count; sample++)
+        {
+            std::vector<float> input(SAMPLE_SIZE);
+            for (auto& value : input)
+            {
+                value = (rand() % 256) / 255.0f;
+            }
+            result.emplace_back(rand() % 10, std::move(input));
+        }
+        return result;
+    }
+}
+
+TEST_CASE("BinaryDataset maps the samples written by write_binary_dataset")
+{
+    const auto type = GENERATE(PixelType::UInt8, PixelType::Float32);
+    const auto data = byte_valued_dataset(37);
+    const std::string filename = "binary_dataset_test.bin";
+
+    REQUIRE(write_binary_dataset(filename, data, type) < 1e-6f);
+    {
+        const BinaryDataset mapped(filename);
+        REQUIRE(mapped.size() == data.size());
+        REQUIRE(mapped.sample_size() == SAMPLE_SIZE);
+        REQUIRE(mapped.pixel_type() == type);
+
+        std::vector<float> copy(SAMPLE_SIZE);
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            const auto sample = mapped[i];
+            REQUIRE(sample.first == data[i].first);
+            REQUIRE(sample.second.size() == SAMPLE_SIZE);
+
+            copy_sample(sample.second, copy.data());
+            for (unsigned int j = 0; j < SAMPLE_SIZE; j++)
+            {
+                REQUIRE(std::abs(copy[j] - data[i].second[j]) < 1e-6f);
+                REQUIRE(sample.second[j] == copy[j]);
+            }
+        }
+        REQUIRE_THROWS_AS(mapped.at(data.size()), std::exception);
+    }
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("NeuroNet reads SampleView inputs like vectors")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+    auto batch_net = net;
+
+    const auto data = byte_valued_dataset(12);
+    const std::string filename = "binary_dataset_view_test.bin";
+    write_binary_dataset(filename, data, PixelType::UInt8);
+    const BinaryDataset mapped(filename);
+    std::remove(filename.c_str());
+
+    std::vector<int> labels;
+    std::vector<SampleView> views;
+    std::vector<std::vector<float>> vectors;
+    for (std::size_t i = 0; i < mapped.size(); i++)
+    {
+        REQUIRE(net.analyze(mapped[i].second) == net.analyze(data[i].second));
+        labels.push_back(mapped[i].first);
+        views.push_back(mapped[i].second);
+        vectors.push_back(data[i].second);
+    }
+
+    REQUIRE(net.train_batch(labels, views, 0.1) == batch_net.train_batch(labels, vectors, 0.1));
+    for (unsigned int layer = 0; layer < net.weights().size(); layer++)
+    {
+        const auto size = net.weights()[layer].size();
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            for (unsigned int j = 0; j < size.second; j++)
+            {
+                REQUIRE(std::abs(net.weights()[layer](i, j) - batch_net.weights()[layer](i, j)) < 1e-6f);
+            }
+        }
+    }
+}
+
+TEST_CASE("BinaryDataset rejects files in other formats")
+{
+    const std::string filename = "binary_dataset_bad.bin";
+    {
+        std::ofstream output(filename);
+        output << "0 0.5 0.5 0.5";
+    }
+
+    REQUIRE_THROWS_AS(BinaryDataset(filename), std::exception);
+    REQUIRE_THROWS_AS(BinaryDataset("missing_dataset.bin"), std::exception);
+
+    // Sample counts past the end of the file, the second one wraps the end offsets
+    // of the labels and of 1 byte samples around to just before their start.
+    write_binary_dataset(filename, byte_valued_dataset(3), PixelType::UInt8);
+    for (const std::uint64_t samples : {std::uint64_t(1) << 40, ~std::uint64_t(0)})
+    {
+        BinaryDatasetHeader header;
+        {
+            std::ifstream input(filename, std::ios::binary);
+            input.read(reinterpret_cast<char*>(&header), sizeof(header));
+        }
+        header.samples = samples;
+        header.sample_size = 1;
+        {
+            std::fstream output(filename, std::ios::binary | std::ios::in | std::ios::out);
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        REQUIRE_THROWS_AS(BinaryDataset(filename), std::runtime_error);
+        REQUIRE_THROWS_AS(BinaryChunkReader(filename), std::runtime_error);
+    }
+    std::remove(filename.c_str());
+}
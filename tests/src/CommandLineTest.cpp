@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "CommandLine.hpp"
+
+TEST_CASE("CommandLine reads values, switches and the command")
+{
+    const char* argv[] = {"neuron_digits", "eval", "--data", "t10k-images-idx3-ubyte", "--batch=32", "--resume", "--threads", "0", "--seconds", "2.5"};
+    const CommandLine line(sizeof(argv) / sizeof(argv[0]), argv);
+
+    REQUIRE(line.command() == "eval");
+    REQUIRE(line.value("data", "") == "t10k-images-idx3-ubyte");
+    REQUIRE(line.unsigned_value("batch", 64) == 32);
+    REQUIRE(line.unsigned_value("threads", 1) == 0);
+    REQUIRE(line.double_value("seconds", 5) == 2.5);
+    REQUIRE(line.has("resume"));
+    REQUIRE(line.value("resume", "x").empty());
+
+    REQUIRE_FALSE(line.has("weights"));
+    REQUIRE(line.value("weights", "weights.bin") == "weights.bin");
+    REQUIRE(line.unsigned_value("epochs", 10) == 10);
+
+    REQUIRE_NOTHROW(line.check_flags({"data", "batch", "resume", "threads", "seconds"}));
+    REQUIRE_THROWS_AS(line.check_flags({"data", "batch", "threads", "seconds"}), std::runtime_error);
+}
+
+TEST_CASE("CommandLine rejects malformed arguments")
+{
+    const char* positional[] = {"neuron_digits", "eval", "weights.bin"};
+    REQUIRE_THROWS_AS(CommandLine(3, positional), std::runtime_error);
+    const char* nothing[] = {"neuron_digits"};
+    REQUIRE_THROWS_AS(CommandLine(1, nothing), std::runtime_error);
+
+    const char* argv[] = {"neuron_digits", "bench", "--batch", "12x", "--threads", "-1", "--seconds", "soon"};
+    const CommandLine line(sizeof(argv) / sizeof(argv[0]), argv);
+    REQUIRE_THROWS_AS(line.unsigned_value("batch", 1), std::runtime_error);
+    REQUIRE_THROWS_AS(line.unsigned_value("threads", 1), std::runtime_error);
+    REQUIRE_THROWS_AS(line.double_value("seconds", 1), std::runtime_error);
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DatasetStream.hpp"
+#include "TestHelpers.hpp"
+
+namespace
+{
+    Dataset numbered_dataset(std::size_t count)
+    {
+        Dataset result;
+        for (std::size_t sample = 0; sample < count; sample++)
+        {
+            std::vector<float> input(SAMPLE_SIZE);
+            for (unsigned int i = 0; i < SAMPLE_SIZE; i++)
+            {
+                input[i] = ((sample * 31 + i) % 256) / 255.0f;
+            }
+            result.emplace_back(sample % 10, std::move(input));
+        }
+        return result;
+    }
+
+    void write_text_dataset(const std::string& filename, const Dataset& data)
+    {
+        std::ofstream output(filename);
+        output.precision(9);
+        for (const auto& sample : data)
+        {
+            output << sample.first;
+            for (const auto value : sample.second)
+            {
+                output << " " << value;
+            }
+            output << "\n";
+        }
+    }
+
+    // Reads one pass and checks it against data.
+    void require_pass(DatasetStream& stream, const Dataset& data)
+    {
+        std::size_t index = 0;
+        std::vector<float> input(SAMPLE_SIZE);
+        while (const SampleChunk* chunk = stream.next())
+        {
+            REQUIRE(chunk->size() <= stream.chunk_size());
+            for (std::size_t i = 0; i < chunk->size(); i++, index++)
+            {
+                REQUIRE(index < data.size());
+                const auto sample = (*chunk)[i];
+                REQUIRE(sample.first == data[index].first);
+
+                copy_sample(sample.second, input.data());
+                for (unsigned int j = 0; j < SAMPLE_SIZE; j++)
+                {
+                    REQUIRE(std::abs(input[j] - data[index].second[j]) < 1e-6f);
+                }
+            }
+        }
+        REQUIRE(index == data.size());
+    }
+}
+
+TEST_CASE("DatasetStream streams every sample once per pass")
+{
+    const std::string format = GENERATE(as<std::string>{}, "binary", "text", "idx");
+    const auto data = numbered_dataset(50);
+    std::string filename = "dataset_stream_test." + format;
+    if (format == "binary")
+    {
+        write_binary_dataset(filename, data, PixelType::UInt8);
+    }
+    else if (format == "text")
+    {
+        write_text_dataset(filename, data);
+    }
+    else
+    {
+        filename = "dataset_stream_test-images-idx3-ubyte";
+        std::vector<std::uint8_t> pixels;
+        std::vector<std::uint8_t> labels;
+        for (const auto& sample : data)
+        {
+            labels.push_back(sample.first);
+            for (const auto value : sample.second)
+            {
+                pixels.push_back(static_cast<std::uint8_t>(std::lround(value * 255)));
+            }
+        }
+        write_idx(filename, {static_cast<std::uint32_t>(data.size()), 28, 28}, pixels);
+        write_idx(IdxDataset::labels_filename_for(filename), {static_cast<std::uint32_t>(data.size())}, labels);
+    }
+
+    {
+        DatasetStream stream(open_chunk_reader(filename), 8, 2);
+        require_pass(stream, data);
+        require_pass(stream, data);
+
+        const auto stats = stream.stats();
+        REQUIRE(stats.samples == 2 * data.size());
+        REQUIRE(stats.chunks == 2 * 7);
+        REQUIRE(stats.stall_seconds >= 0);
+    }
+    std::remove(filename.c_str());
+    if (format == "idx")
+        std::remove(IdxDataset::labels_filename_for(filename).c_str());
+}
+
+TEST_CASE("DatasetStream rethrows reader errors in next()")
+{
+    const std::string filename = "dataset_stream_truncated.txt";
+    {
+        std::ofstream output(filename);
+        output << "1 0.5 0.5 0.5";
+    }
+
+    DatasetStream stream(open_chunk_reader(filename), 4);
+    REQUIRE_THROWS_AS(stream.next(), std::exception);
+    std::remove(filename.c_str());
+
+    REQUIRE_THROWS_AS(open_chunk_reader("missing_dataset.txt"), std::exception);
+}
+
+TEST_CASE("TextChunkReader throws on a label that isn't a number")
+{
+    const std::string filename = "dataset_stream_bad_label.txt";
+    write_text_dataset(filename, numbered_dataset(2));
+    {
+        std::ofstream output(filename, std::ios::app);
+        output << "x 0.5\n";
+    }
+
+    TextChunkReader reader(filename);
+    SampleChunk chunk;
+    REQUIRE_THROWS_AS(reader.read(chunk, 10), std::runtime_error);
+    std::remove(filename.c_str());
+}
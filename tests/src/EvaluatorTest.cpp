@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Evaluator.hpp"
+#include "TestHelpers.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+TEST_CASE("Evaluator counts like analyze on every thread and batch size")
+{
+    const unsigned int threads = GENERATE(as<unsigned int>{}, 1, 3);
+    const unsigned int batch_size = GENERATE(as<unsigned int>{}, 7, 256);
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+    const auto data = random_dataset(300);
+
+    std::vector<SampleView> inputs;
+    for (const auto& sample : data)
+    {
+        inputs.push_back(view_of(sample.second));
+    }
+    BasicMatrix<float> scores(0, 0);
+    const auto answers = net.analyze_batch(inputs, &scores);
+
+    std::vector<std::size_t> confusion(100, 0);
+    std::size_t correct = 0;
+    std::size_t top_3 = 0;
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        const int label = data[i].first;
+        confusion[label * 10 + answers[i]]++;
+        correct += answers[i] == label;
+
+        unsigned int better = 0;
+        for (unsigned int output = 0; output < 10; output++)
+        {
+            better += scores(i, output) > scores(i, label);
+        }
+        top_3 += better < 3;
+    }
+
+    Evaluator evaluator(threads, batch_size, 3);
+    REQUIRE(evaluator.threads() == threads);
+    LatencyHistogram latency;
+    const auto report = evaluator.evaluate(net, data, &latency);
+
+    REQUIRE(report.samples == data.size());
+    REQUIRE(report.classes == 10);
+    REQUIRE(report.top_k == 3);
+    REQUIRE(report.confusion == confusion);
+    REQUIRE(report.correct == correct);
+    REQUIRE(report.top_k_correct == top_3);
+    REQUIRE(report.invalid == 0);
+    REQUIRE(report.top_k_correct >= report.correct);
+    REQUIRE(report.accuracy() == correct / 300.0);
+    REQUIRE(report.samples_per_second > 0);
+    REQUIRE(latency.count() >= (data.size() + batch_size - 1) / batch_size);
+
+    // Workspaces and score buffers of the first pass are reused, short batches included.
+    const auto allocations = Matrix::allocation_count();
+    const auto again = evaluator.evaluate(net, data);
+    REQUIRE(Matrix::allocation_count() == allocations);
+    REQUIRE(again.confusion == confusion);
+    REQUIRE(again.top_k_correct == top_3);
+}
+
+TEST_CASE("Evaluator top-1 is the accuracy, top-10 of ten classes takes every sample")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({SAMPLE_SIZE, 16, 10}, activator);
+    const auto data = random_dataset(50);
+
+    const auto top_1 = Evaluator(2, 16, 1).evaluate(net, data);
+    REQUIRE(top_1.top_k_correct == top_1.correct);
+
+    const auto top_all = Evaluator(2, 16, 20).evaluate(net, data);
+    REQUIRE(top_all.top_k == 10);
+    REQUIRE(top_all.top_k_correct == data.size());
+
+    const auto empty = Evaluator(2).evaluate(net, Dataset());
+    REQUIRE(empty.samples == 0);
+    REQUIRE(empty.accuracy() == 0);
+
+    auto wrong_label = data;
+    wrong_label[17].first = 10;
+    REQUIRE_THROWS_AS(Evaluator(2).evaluate(net, wrong_label), std::runtime_error);
+    REQUIRE_THROWS_AS(Evaluator(1, 0), std::runtime_error);
+}
+
+TEST_CASE("Evaluator counts samples with NaN outputs as wrong")
+{
+    // Every weight and bios NaN. ModReLU passes NaN on, so no output beats another
+    // and analyze has no answer; the sigmoid kernels would clamp it to 1.
+    const std::string filename = "evaluator_nan_weights.txt";
+    {
+        std::ofstream output(filename);
+        output << "3 " << SAMPLE_SIZE << " 4 10";
+        for (unsigned int i = 0; i < SAMPLE_SIZE * 4 + 4 * 10 + 4 + 10; i++)
+        {
+            output << " nan";
+        }
+    }
+    auto activator = std::make_shared<ModReluFunc>();
+    NeuroNet net({1, 1}, activator);
+    net.read_weights(filename);
+    std::remove(filename.c_str());
+
+    const auto data = random_dataset(40);
+    const unsigned int top_k = GENERATE(as<unsigned int>{}, 1, 3);
+    const auto report = Evaluator(2, 16, top_k).evaluate(net, data);
+    REQUIRE(report.samples == data.size());
+    REQUIRE(report.invalid == data.size());
+    REQUIRE(report.correct == 0);
+    REQUIRE(report.top_k_correct == 0);
+    REQUIRE(report.accuracy() == 0);
+    REQUIRE(report.confusion == std::vector<std::size_t>(100, 0));
+}
+
+TEST_CASE("Evaluator report gives recall and precision from the confusion matrix")
+{
+    Evaluator::Report report;
+    report.classes = 2;
+    // Four 0s answered 0, 0, 0, 1; two 1s answered 0, 1.
+    report.confusion = {3, 1, 1, 1};
+
+    REQUIRE(report.count(0, 1) == 1);
+    REQUIRE(report.recall(0) == 0.75);
+    REQUIRE(report.recall(1) == 0.5);
+    REQUIRE(report.precision(0) == 0.75);
+    REQUIRE(report.precision(1) == 0.5);
+}
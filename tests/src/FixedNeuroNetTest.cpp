@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "FixedNeuroNet.hpp"
+#include "NeuroNet.hpp"
+#include "WorkerPool.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+TEST_CASE("FixedNeuroNet gives the same predictions as NeuroNet for the same weight file")
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<IActivatorFunc> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<SigmoidFunc>();
+    else
+        activator = std::make_shared<ModReluFunc>();
+
+    NeuroNet trained({784, 256, 10}, activator);
+    std::vector<std::vector<float>> samples;
+    for (int sample = 0; sample < 40; sample++)
+    {
+        std::vector<float> input(784);
+        for (auto& value : input)
+        {
+            value = static_cast<float>(rand()) / RAND_MAX;
+        }
+        samples.push_back(input);
+
+        trained.analyze(input);
+        trained.back_propagate(sample % 10, 0.1);
+    }
+
+    const std::string filename = "fixed_neuronet_test_weights.txt";
+    trained.save_weights(filename);
+
+    NeuroNet dynamic({784, 256, 10}, activator);
+    dynamic.read_weights(filename);
+    auto fixed = std::make_unique<DigitsNeuroNet>(activator);
+    fixed->read_weights(filename);
+    std::remove(filename.c_str());
+
+    for (const auto& input : samples)
+    {
+        REQUIRE(fixed->analyze(input) == dynamic.analyze(input));
+    }
+}
+
+TEST_CASE("FixedNeuroNet rejects weights of a different topology")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet other({784, 64, 10}, activator);
+    auto fixed = std::make_unique<DigitsNeuroNet>(activator);
+
+    REQUIRE_THROWS_AS(fixed->load(other), std::exception);
+    REQUIRE_THROWS_AS(fixed->analyze(std::vector<float>(100)), std::exception);
+}
+
+TEST_CASE("Threads share one const FixedNeuroNet through their own workspaces")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet dynamic({784, 256, 10}, activator);
+    auto fixed = std::make_unique<DigitsNeuroNet>(activator);
+    fixed->load(dynamic);
+    const DigitsNeuroNet& net = *fixed;
+
+    std::vector<std::vector<float>> samples;
+    std::vector<int> expected;
+    for (int sample = 0; sample < 40; sample++)
+    {
+        std::vector<float> input(784);
+        for (auto& value : input)
+        {
+            value = static_cast<float>(rand()) / RAND_MAX;
+        }
+        samples.push_back(input);
+        expected.push_back(fixed->analyze(input));
+    }
+
+    constexpr unsigned int threads = 4;
+    std::vector<std::vector<int>> answers(threads);
+    WorkerPool pool(threads);
+    pool.run([&](unsigned int thread) {
+        auto workspace = std::make_unique<DigitsNeuroNet::Workspace>();
+        for (const auto& input : samples)
+        {
+            answers[thread].push_back(net.analyze(input, *workspace));
+        }
+    });
+
+    for (const auto& thread_answers : answers)
+    {
+        REQUIRE(thread_answers == expected);
+    }
+}
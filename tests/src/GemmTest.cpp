@@ -0,0 +1,191 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "kernels/Gemm.hpp"
+
+#include "TestHelpers.hpp"
+
+namespace
+{
+    template<typename T = double>
+    std::vector<T> random_values(std::size_t count)
+    {
+        std::vector<T> result(count);
+        for (auto& value : result)
+        {
+            value = static_cast<T>(rand()) / RAND_MAX - static_cast<T>(0.5);
+        }
+        return result;
+    }
+
+    // Accumulated rounding error allowed for an n-term dot product.
+    template<typename T>
+    double tolerance(unsigned int n)
+    {
+        return (sizeof(T) == sizeof(float) ? 1e-5 : 1e-12) * (n + 1);
+    }
+}
+
+TEMPLATE_TEST_CASE("kernels::gemv matches the naive product on every supported instruction set", "", float, double)
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 3, 10, 256);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 7, 256, 784);
+    const std::size_t lda = n + 5;
+
+    const auto a = random_values<TestType>(m * lda);
+    const auto x = random_values<TestType>(n);
+    std::vector<TestType> y(m, -1);
+
+    kernels::gemv(m, n, a.data(), lda, x.data(), y.data());
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        double expected = 0;
+        for (unsigned int j = 0; j < n; j++)
+        {
+            expected += a[i * lda + j] * x[j];
+        }
+        REQUIRE(std::abs(y[i] - expected) < tolerance<TestType>(n));
+    }
+}
+
+TEMPLATE_TEST_CASE("kernels::gemm matches the naive product on every supported instruction set", "", float, double)
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 5, 70);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 17, 40);
+    const unsigned int k = GENERATE(as<unsigned int>{}, 3, 300);
+
+    const auto a = random_values<TestType>(m * k);
+    const auto b = random_values<TestType>(k * n);
+    std::vector<TestType> c(m * n, -1);
+
+    kernels::gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n);
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        for (unsigned int j = 0; j < n; j++)
+        {
+            double expected = 0;
+            for (unsigned int p = 0; p < k; p++)
+            {
+                expected += a[i * k + p] * b[p * n + j];
+            }
+            REQUIRE(std::abs(c[i * n + j] - expected) < tolerance<TestType>(k));
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("kernels::gemm_tn matches the naive product with the transposed left matrix", "", float, double)
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 5, 70);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 17, 40);
+    const unsigned int k = GENERATE(as<unsigned int>{}, 3, 300);
+    const std::size_t lda = m + 3;
+
+    const auto a = random_values<TestType>(k * lda);
+    const auto b = random_values<TestType>(k * n);
+    std::vector<TestType> c(m * n, -1);
+
+    kernels::gemm_tn(m, n, k, a.data(), lda, b.data(), n, c.data(), n);
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        for (unsigned int j = 0; j < n; j++)
+        {
+            double expected = 0;
+            for (unsigned int p = 0; p < k; p++)
+            {
+                expected += a[p * lda + i] * b[p * n + j];
+            }
+            REQUIRE(std::abs(c[i * n + j] - expected) < tolerance<TestType>(k));
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("kernels::gemv_t matches the product with the transposed matrix", "", float, double)
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 6, 10, 256);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 13, 256);
+    const std::size_t lda = n + 3;
+
+    const auto a = random_values<TestType>(m * lda);
+    const auto x = random_values<TestType>(m);
+    std::vector<TestType> y(n, -1);
+
+    kernels::gemv_t(m, n, a.data(), lda, x.data(), y.data());
+
+    for (unsigned int j = 0; j < n; j++)
+    {
+        double expected = 0;
+        for (unsigned int i = 0; i < m; i++)
+        {
+            expected += a[i * lda + j] * x[i];
+        }
+        REQUIRE(std::abs(y[j] - expected) < tolerance<TestType>(m));
+    }
+}
+
+TEMPLATE_TEST_CASE("kernels::rank1_update adds the scaled outer product and bias", "", float, double)
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 10, 256);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 21, 784);
+    const std::size_t lda = n + 1;
+    const TestType alpha = 0.15;
+
+    const auto original = random_values<TestType>(m * lda);
+    const auto original_bias = random_values<TestType>(m);
+    const auto u = random_values<TestType>(m);
+    const auto v = random_values<TestType>(n);
+
+    auto a = original;
+    auto bias = original_bias;
+    kernels::rank1_update(m, n, a.data(), lda, alpha, u.data(), v.data(), bias.data());
+
+    for (unsigned int i = 0; i < m; i++)
+    {
+        for (unsigned int j = 0; j < n; j++)
+        {
+            REQUIRE(std::abs(a[i * lda + j] - (original[i * lda + j] + alpha * u[i] * v[j])) < tolerance<TestType>(1));
+        }
+        REQUIRE(std::abs(bias[i] - (original_bias[i] + alpha * u[i])) < tolerance<TestType>(1));
+    }
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "HogwildTrainer.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    // Label k lights up the k-th band of pixels, on top of some noise.
+    Dataset banded_dataset(std::size_t count)
+    {
+        Dataset result;
+        for (std::size_t sample = 0; sample < count; sample++)
+        {
+            const int label = rand() % 10;
+            std::vector<float> input(SAMPLE_SIZE);
+            for (unsigned int i = 0; i < SAMPLE_SIZE; i++)
+            {
+                const bool band = i * 10 / SAMPLE_SIZE == static_cast<unsigned int>(label);
+                input[i] = (band ? 0.8f : 0.0f) + 0.2f * rand() / RAND_MAX;
+            }
+            result.emplace_back(label, std::move(input));
+        }
+        return result;
+    }
+}
+
+TEST_CASE("HogwildTrainer with one thread is plain sequential SGD")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto data = banded_dataset(100);
+
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+    auto reference = net;
+
+    HogwildTrainer trainer(net, 1);
+    const auto report = trainer.train(data, 2, 0.1);
+
+    int good = 0;
+    for (int epoch = 0; epoch < 2; epoch++)
+    {
+        for (const auto& sample : data)
+        {
+            const auto answer = reference.analyze(sample.second);
+            good += epoch == 1 and answer == sample.first;
+            reference.back_propagate(sample.first, 0.1);
+        }
+    }
+
+    REQUIRE(report.samples == 200);
+    REQUIRE(report.last_epoch_accuracy == good / 100.0);
+    for (unsigned int layer = 0; layer < net.weights().size(); layer++)
+    {
+        const auto size = net.weights()[layer].size();
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            for (unsigned int j = 0; j < size.second; j++)
+            {
+                REQUIRE(net.weights()[layer](i, j) == reference.weights()[layer](i, j));
+            }
+        }
+    }
+}
+
+TEST_CASE("HogwildTrainer learns with concurrent lock-free updates")
+{
+    const unsigned int threads = GENERATE(as<unsigned int>{}, 2, 4);
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto data = banded_dataset(500);
+
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+    HogwildTrainer trainer(net, threads);
+    REQUIRE(trainer.threads() == threads);
+
+    // The 32 hidden sigmoids start saturated on these inputs, where the true
+    // derivative y * (1 - y) is small, so it takes a bold rate to learn in 5 epochs.
+    const auto report = trainer.train(data, 5, 1.0);
+    REQUIRE(report.samples == 2500);
+    REQUIRE(report.samples_per_second > 0);
+
+    int good = 0;
+    for (const auto& sample : data)
+    {
+        good += net.analyze(sample.second) == sample.first;
+    }
+    REQUIRE(good > 450);
+}
+
+TEST_CASE("NeuroNet::analyze with a separate workspace matches the plain overload")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto data = banded_dataset(20);
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+
+    NeuroNet::SampleWorkspace workspace;
+    for (const auto& sample : data)
+    {
+        REQUIRE(static_cast<const NeuroNet&>(net).analyze(sample.second, workspace) == net.analyze(sample.second));
+    }
+
+    NeuroNet::SampleWorkspace empty;
+    REQUIRE_THROWS_AS(net.back_propagate(1, 0.1, empty), std::exception);
+}
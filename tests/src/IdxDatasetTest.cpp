@@ -0,0 +1,93 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "IdxDataset.hpp"
+#include "TestHelpers.hpp"
+
+TEST_CASE("IdxDataset maps MNIST images and labels")
+{
+    const std::string images_file = "idx_test-images-idx3-ubyte";
+    const std::string labels_file = "idx_test-labels-idx1-ubyte";
+    const std::uint32_t count = 5;
+    const std::uint32_t rows = 28;
+    const std::uint32_t columns = 28;
+
+    std::vector<std::uint8_t> pixels(count * rows * columns);
+    for (std::size_t i = 0; i < pixels.size(); i++)
+    {
+        pixels[i] = static_cast<std::uint8_t>(i * 7);
+    }
+    const std::vector<std::uint8_t> labels = {5, 0, 4, 1, 9};
+
+    write_idx(images_file, {count, rows, columns}, pixels);
+    write_idx(labels_file, {count}, labels);
+
+    REQUIRE(IdxDataset::labels_filename_for(images_file) == labels_file);
+
+    const IdxDataset data(images_file);
+    REQUIRE(data.size() == count);
+    REQUIRE(data.sample_size() == rows * columns);
+    REQUIRE(data.pixel_type() == PixelType::UInt8);
+
+    std::vector<float> input(data.sample_size());
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        const auto sample = data[i];
+        REQUIRE(sample.first == labels[i]);
+
+        copy_sample(sample.second, input.data());
+        for (unsigned int j = 0; j < data.sample_size(); j++)
+        {
+            const auto expected = pixels[i * data.sample_size() + j] * (1.0f / 255);
+            REQUIRE(input[j] == expected);
+            REQUIRE(sample.second[j] == expected);
+        }
+    }
+    REQUIRE_THROWS_AS(data.at(count), std::exception);
+
+    std::remove(images_file.c_str());
+    std::remove(labels_file.c_str());
+}
+
+TEST_CASE("IdxDataset rejects mismatched or malformed files")
+{
+    const std::string images_file = "idx_bad-images-idx3-ubyte";
+    const std::string labels_file = "idx_bad-labels-idx1-ubyte";
+    write_idx(images_file, {3, 2, 2}, std::vector<std::uint8_t>(12));
+
+    SECTION("Label count differs")
+    {
+        write_idx(labels_file, {4}, std::vector<std::uint8_t>(4));
+        REQUIRE_THROWS_AS(IdxDataset(images_file), std::exception);
+    }
+    SECTION("Labels file is truncated")
+    {
+        write_idx(labels_file, {3}, std::vector<std::uint8_t>(2));
+        REQUIRE_THROWS_AS(IdxDataset(images_file), std::exception);
+    }
+    SECTION("Labels file isn't IDX")
+    {
+        std::ofstream(labels_file) << "0 0.5 0.5";
+        REQUIRE_THROWS_AS(IdxDataset(images_file), std::exception);
+    }
+    SECTION("Image dimensions wrap around")
+    {
+        // 2 * 2 * 5 * 5581 * 8681 * 49477 * 384773 is 2^64 + 4, i.e. 4 bytes per image in 64 bits.
+        write_idx(images_file, {3, 2, 2, 5, 5581, 8681, 49477, 384773}, std::vector<std::uint8_t>(12));
+        write_idx(labels_file, {3}, std::vector<std::uint8_t>(3));
+        REQUIRE_THROWS_AS(IdxDataset(images_file), std::exception);
+    }
+    SECTION("Files are swapped")
+    {
+        write_idx(labels_file, {3}, std::vector<std::uint8_t>(3));
+        REQUIRE_THROWS_AS(IdxDataset(labels_file, images_file), std::exception);
+    }
+
+    std::remove(images_file.c_str());
+    std::remove(labels_file.c_str());
+}
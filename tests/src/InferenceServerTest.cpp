@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InferenceServer.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+TEST_CASE("Endpoint parses unix and tcp addresses")
+{
+    REQUIRE(Endpoint::parse("unix:/tmp/digits.sock").kind == Endpoint::Kind::Unix);
+    REQUIRE(Endpoint::parse("unix:/tmp/digits.sock").path == "/tmp/digits.sock");
+
+    const auto tcp = Endpoint::parse("tcp:0.0.0.0:5555");
+    REQUIRE(tcp.kind == Endpoint::Kind::Tcp);
+    REQUIRE(tcp.host == "0.0.0.0");
+    REQUIRE(tcp.port == 5555);
+    REQUIRE(Endpoint::parse("5555").host == "127.0.0.1");
+    REQUIRE(Endpoint::parse("localhost:80").port == 80);
+
+    REQUIRE_THROWS_AS(Endpoint::parse("tcp:127.0.0.1:http"), std::exception);
+    REQUIRE_THROWS_AS(Endpoint::parse("tcp:127.0.0.1:70000"), std::exception);
+    REQUIRE_THROWS_AS(Endpoint::parse("unix:"), std::exception);
+}
+
+TEST_CASE("InferenceServer replaces a stale socket but not another file")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 32, 10}, activator);
+    MicroBatcher batcher(net, BatchingOptions());
+    const auto endpoint = Endpoint::parse("unix:inference_server_path_test.sock");
+
+    // A socket bound and closed without unlinking, as a crashed server leaves it.
+    sockaddr_storage address;
+    socklen_t length;
+    const int stale = detail::open_socket(endpoint, address, length);
+    REQUIRE(::bind(stale, reinterpret_cast<sockaddr*>(&address), length) == 0);
+    ::close(stale);
+    {
+        InferenceServer server(batcher, endpoint);
+    }
+
+    std::ofstream(endpoint.path) << "not a socket";
+    REQUIRE_THROWS_AS(InferenceServer(batcher, endpoint), std::runtime_error);
+    std::string contents;
+    std::ifstream(endpoint.path) >> contents;
+    REQUIRE(contents == "not");
+    std::remove(endpoint.path.c_str());
+}
+
+TEST_CASE("InferenceServer answers concurrent clients like the network")
+{
+    const bool unix_socket = GENERATE(true, false);
+    const auto endpoint = Endpoint::parse(unix_socket ? "unix:inference_server_test.sock" : "tcp:127.0.0.1:0");
+
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 32, 10}, activator);
+
+    BatchingOptions options;
+    options.max_batch = 8;
+    options.max_delay = std::chrono::milliseconds(1);
+    MicroBatcher batcher(net, options);
+    InferenceServer server(batcher, endpoint);
+    std::thread accepting([&server]() { server.run(); });
+
+    constexpr unsigned int clients = 4;
+    constexpr unsigned int requests = 25;
+    std::vector<std::vector<std::uint8_t>> pixels;
+    for (unsigned int i = 0; i < clients * requests; i++)
+    {
+        std::vector<std::uint8_t> sample(784);
+        for (auto& pixel : sample)
+        {
+            pixel = static_cast<std::uint8_t>(rand());
+        }
+        pixels.push_back(std::move(sample));
+    }
+
+    std::vector<int> answers(pixels.size(), -2);
+    std::vector<std::thread> threads;
+    for (unsigned int client = 0; client < clients; client++)
+    {
+        threads.emplace_back([&, client]() {
+            InferenceClient connection(server.endpoint());
+            for (unsigned int request = 0; request < requests; request++)
+            {
+                const auto index = client * requests + request;
+                answers[index] = connection.classify(pixels[index].data(), pixels[index].size());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    NeuroNet::SampleWorkspace workspace;
+    for (std::size_t i = 0; i < pixels.size(); i++)
+    {
+        const SampleView view(pixels[i].data(), pixels[i].size(), PixelType::UInt8);
+        REQUIRE(answers[i] == net.analyze(view, workspace));
+    }
+
+    InferenceClient client(server.endpoint());
+    const std::vector<std::uint8_t> wrong_size(100);
+    REQUIRE(client.classify(wrong_size.data(), wrong_size.size()) == -1);
+
+    const auto stats = client.stats();
+    REQUIRE(stats.requests == pixels.size());
+    REQUIRE(stats.batches > 0);
+    REQUIRE(stats.p99_seconds >= stats.p50_seconds);
+
+    server.stop();
+    accepting.join();
+}
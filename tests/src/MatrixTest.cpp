@@ -2,6 +2,7 @@
 #include <catch2/generators/catch_generators.hpp>
 
 #include <cmath>
+#include <cstdint>
 
 #include "Matrix.hpp"
 
@@ -543,4 +544,186 @@ TEST_CASE("Matrix::operator-() performs correct substraction of single row matri
             Matrix c = a - test_vector; 
         }(), std::exception);
     } // END_OF_CASE_2
-}
\ No newline at end of file
+}
+
+TEST_CASE("Matrix keeps its elements in a single aligned row-major buffer")
+{
+    const unsigned int rows = GENERATE(as<unsigned int>{}, 1, 10, 256);
+    const unsigned int cols = GENERATE(as<unsigned int>{}, 1, 10, 784);
+    Matrix a(rows, cols, 0);
+
+    REQUIRE(reinterpret_cast<std::uintptr_t>(a.data()) % Matrix::ALIGNMENT == 0);
+    REQUIRE(a.stride() >= cols);
+
+    for (int i = 0; i < rows; i++)
+    {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(a.row(i)) % (cols == 1 ? sizeof(double) : Matrix::ALIGNMENT) == 0);
+        for (int j = 0; j < cols; j++)
+        {
+            a(i, j) = i * cols + j;
+        }
+    }
+
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            REQUIRE(a.data()[i * a.stride() + j] == i * cols + j);
+            REQUIRE(a.row(i)[j] == a.unchecked(i, j));
+        }
+    }
+}
+
+TEST_CASE("Matrix column vector is stored densely")
+{
+    std::vector<double> test_vector = {1.5, 2.5, 3.1, 4.9, 5};
+    Matrix a = test_vector;
+
+    REQUIRE(a.stride() == 1);
+    for (int i = 0; i < test_vector.size(); i++)
+    {
+        REQUIRE(a.data()[i] == test_vector.at(i));
+    }
+}
+
+TEST_CASE("Matrix expressions evaluate chained elementwise arithmetic")
+{
+    Matrix a(4, 3, 0);
+    Matrix b(4, 3, 0);
+    Matrix c(4, 3, 0);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            a(i, j) = i + j;
+            b(i, j) = i * j;
+            c(i, j) = 1.5;
+        }
+    }
+
+    Matrix d = a + b * 2 - 0.5 * c;
+
+    REQUIRE(d.size().first == 4);
+    REQUIRE(d.size().second == 3);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            REQUIRE(d(i, j) == a(i, j) + b(i, j) * 2 - 0.5 * c(i, j));
+        }
+    }
+
+    REQUIRE_THROWS_AS([&](){
+        Matrix e = a + b * 2 - Matrix(3, 4);
+    }(), std::exception);
+}
+
+TEST_CASE("Matrix expressions may read the matrix they are assigned to")
+{
+    Matrix a(3, 5, 2);
+    Matrix b(3, 5, 1);
+
+    a = a + b * 3;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 5; j++)
+            REQUIRE(a(i, j) == 5);
+
+    a += b * 0.5;
+    a -= b;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 5; j++)
+            REQUIRE(a(i, j) == 4.5);
+
+    REQUIRE_THROWS_AS(a += Matrix(5, 3), std::exception);
+}
+
+TEST_CASE("Matrix move and assignment reuse existing buffers")
+{
+    Matrix a(20, 30, 1.5);
+    const double* a_data = a.data();
+
+    const auto allocations = Matrix::allocation_count();
+    Matrix b = std::move(a);
+    REQUIRE(b.data() == a_data);
+    REQUIRE(b(19, 29) == 1.5);
+
+    Matrix c(20, 30, 0);
+    const auto after_constructions = Matrix::allocation_count();
+    REQUIRE(after_constructions == allocations + 1);
+
+    c = b;
+    c = b + b * 2;
+    c = Matrix(10, 10, 4);
+    REQUIRE(c(9, 9) == 4);
+
+    Matrix d(5, 1, 0);
+    d = std::vector<double>{1, 2, 3, 4, 5};
+    d = std::vector<double>{5, 4, 3};
+    REQUIRE(d.size().first == 3);
+    REQUIRE(d(0, 0) == 5);
+
+    // Only the temporaries constructed above allocate, the assignments do not.
+    REQUIRE(Matrix::allocation_count() == after_constructions + 2);
+}
+
+TEST_CASE("Matrix::view works on borrowed memory without allocating")
+{
+    alignas(Matrix::ALIGNMENT) double buffer[3 * 8] = {};
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int j = 0; j < 5; j++)
+        {
+            buffer[i * 8 + j] = i * 10 + j;
+        }
+    }
+
+    const auto allocations = Matrix::allocation_count();
+    Matrix view = Matrix::view(buffer, 3, 5, 8);
+    REQUIRE_FALSE(view.owns_data());
+    REQUIRE(view.data() == buffer);
+    REQUIRE(view.stride() == 8);
+    REQUIRE(view(2, 4) == 24);
+
+    view(1, 1) = -1;
+    REQUIRE(buffer[9] == -1);
+
+    Matrix moved = std::move(view);
+    REQUIRE(moved.data() == buffer);
+    REQUIRE(Matrix::allocation_count() == allocations);
+
+    Matrix copy = moved;
+    REQUIRE(copy.owns_data());
+    REQUIRE(copy.data() != buffer);
+    REQUIRE(copy(2, 4) == 24);
+
+    REQUIRE_THROWS_AS(Matrix::view(buffer, 3, 5, 4), std::exception);
+    REQUIRE_THROWS_AS(Matrix::view(buffer + 1, 3, 5, 8), std::exception);
+}
+
+TEST_CASE("Matrix copies of a view with a stride of its own read only the view's rows")
+{
+    // 17 doubles have a natural stride of 24, the view's rows are 20 apart.
+    alignas(Matrix::ALIGNMENT) double buffer[3 * 20] = {};
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int j = 0; j < 17; j++)
+        {
+            buffer[i * 20 + j] = i * 100 + j;
+        }
+    }
+
+    const Matrix view = Matrix::view(buffer, 3, 17, 20);
+    Matrix copy = view;
+    REQUIRE(copy.stride() == Matrix::natural_stride(17));
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int j = 0; j < 17; j++)
+        {
+            REQUIRE(copy(i, j) == i * 100 + j);
+        }
+    }
+
+    Matrix assigned(1, 1);
+    assigned = view;
+    REQUIRE(assigned(2, 16) == 216);
+}
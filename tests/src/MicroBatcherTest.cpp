@@ -0,0 +1,117 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "MicroBatcher.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    std::vector<std::uint8_t> random_pixels(unsigned int size)
+    {
+        std::vector<std::uint8_t> pixels(size);
+        for (auto& pixel : pixels)
+        {
+            pixel = static_cast<std::uint8_t>(rand());
+        }
+        return pixels;
+    }
+}
+
+TEST_CASE("LatencyHistogram percentiles are within a sixteenth of the exact ones")
+{
+    LatencyHistogram histogram;
+    REQUIRE(histogram.percentile(0.5) == 0);
+
+    // 1us, 2us, ... 1000us.
+    for (int i = 1; i <= 1000; i++)
+    {
+        histogram.record(i * 1e-6);
+    }
+    REQUIRE(histogram.count() == 1000);
+
+    const double p50 = histogram.percentile(0.5);
+    const double p99 = histogram.percentile(0.99);
+    REQUIRE(p50 >= 500e-6);
+    REQUIRE(p50 <= 500e-6 * (1 + 1.0 / 16));
+    REQUIRE(p99 >= 990e-6);
+    REQUIRE(p99 <= 990e-6 * (1 + 1.0 / 16));
+    REQUIRE(histogram.percentile(1) >= 1000e-6);
+
+    histogram.reset();
+    REQUIRE(histogram.count() == 0);
+    histogram.record(3600);
+    REQUIRE(histogram.percentile(0.5) > 1000);
+}
+
+TEST_CASE("MicroBatcher answers every request like analyze")
+{
+    const unsigned int threads = GENERATE(as<unsigned int>{}, 1, 3);
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 32, 10}, activator);
+
+    std::vector<std::vector<std::uint8_t>> requests;
+    for (int i = 0; i < 100; i++)
+    {
+        requests.push_back(random_pixels(784));
+    }
+
+    BatchingOptions options;
+    options.max_batch = 16;
+    options.max_delay = std::chrono::milliseconds(2);
+    options.threads = threads;
+    MicroBatcher batcher(net, options);
+
+    std::vector<std::future<int>> answers;
+    for (const auto& pixels : requests)
+    {
+        answers.push_back(batcher.submit(pixels));
+    }
+
+    NeuroNet::SampleWorkspace workspace;
+    for (std::size_t i = 0; i < requests.size(); i++)
+    {
+        const SampleView view(requests[i].data(), requests[i].size(), PixelType::UInt8);
+        REQUIRE(answers[i].get() == net.analyze(view, workspace));
+    }
+
+    const auto stats = batcher.stats();
+    REQUIRE(stats.requests == requests.size());
+    // Submitted faster than a batch runs, so most batches are full.
+    REQUIRE(stats.batches >= requests.size() / options.max_batch);
+    REQUIRE(stats.batches < requests.size());
+    REQUIRE(stats.mean_batch <= options.max_batch);
+    REQUIRE(stats.p50_seconds > 0);
+    REQUIRE(stats.p99_seconds >= stats.p50_seconds);
+    REQUIRE(stats.requests_per_second > 0);
+
+    REQUIRE_THROWS_AS(batcher.submit(random_pixels(100)), std::exception);
+}
+
+TEST_CASE("MicroBatcher runs a lone request once it has waited max_delay")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 32, 10}, activator);
+
+    BatchingOptions options;
+    options.max_batch = 64;
+    options.max_delay = std::chrono::milliseconds(20);
+    MicroBatcher batcher(net, options);
+
+    const auto start_point = std::chrono::steady_clock::now();
+    auto answer = batcher.submit(random_pixels(784));
+    REQUIRE(answer.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(std::chrono::steady_clock::now() - start_point >= options.max_delay);
+    REQUIRE(answer.get() >= 0);
+
+    const auto stats = batcher.stats();
+    REQUIRE(stats.requests == 1);
+    REQUIRE(stats.batches == 1);
+    REQUIRE(stats.p50_seconds >= 0.02);
+}
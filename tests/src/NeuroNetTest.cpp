@@ -0,0 +1,380 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "NeuroNet.hpp"
+#include "WorkerPool.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    template<typename T>
+    struct TestLayers
+    {
+        std::vector<unsigned int> sizes;
+        std::vector<BasicMatrix<T>> weights;
+        std::vector<BasicMatrix<T>> bioses;
+    };
+
+    template<typename T>
+    TestLayers<T> random_layers(const std::vector<unsigned int>& sizes)
+    {
+        TestLayers<T> result{sizes, {}, {}};
+        for (int layer = 0; layer + 1 < sizes.size(); layer++)
+        {
+            BasicMatrix<T> weights(sizes[layer + 1], sizes[layer]);
+            BasicMatrix<T> bioses(sizes[layer + 1], 1);
+            for (int i = 0; i < sizes[layer + 1]; i++)
+            {
+                for (int j = 0; j < sizes[layer]; j++)
+                {
+                    weights(i, j) = static_cast<double>(rand()) / RAND_MAX - 0.5;
+                }
+                bioses(i, 0) = static_cast<double>(rand()) / RAND_MAX - 0.5;
+            }
+            result.weights.push_back(weights);
+            result.bioses.push_back(bioses);
+        }
+        return result;
+    }
+
+    template<typename T>
+    void write_weights(const std::string& filename, const TestLayers<T>& layers)
+    {
+        std::ofstream output(filename);
+        output.precision(17);
+        output << layers.sizes.size() << " ";
+        for (auto size : layers.sizes)
+            output << size << " ";
+
+        for (const auto* group : {&layers.weights, &layers.bioses})
+        {
+            for (const auto& matrix : *group)
+            {
+                for (int i = 0; i < matrix.size().first; i++)
+                    for (int j = 0; j < matrix.size().second; j++)
+                        output << matrix(i, j) << " ";
+            }
+        }
+    }
+
+    template<typename T = float>
+    std::vector<T> random_input(unsigned int size)
+    {
+        std::vector<T> input(size);
+        for (auto& value : input)
+        {
+            value = static_cast<double>(rand()) / RAND_MAX;
+        }
+        return input;
+    }
+
+    // Unfused forward pass built from the plain Matrix operators.
+    template<typename T>
+    int reference_analyze(const TestLayers<T>& layers, BasicActivatorFunc<T>& activator, const std::vector<T>& input)
+    {
+        BasicMatrix<T> neurons = input;
+        for (int layer = 0; layer < layers.weights.size(); layer++)
+        {
+            BasicMatrix<T> sum = layers.weights[layer] * neurons;
+            neurons = activator.func(sum + layers.bioses[layer]);
+        }
+
+        int best = 0;
+        for (int i = 1; i < neurons.size().first; i++)
+        {
+            if (neurons(i, 0) > neurons(best, 0))
+                best = i;
+        }
+        return best;
+    }
+}
+
+TEMPLATE_TEST_CASE("NeuroNet::analyze gives the same answers as the unfused Matrix arithmetic", "", float, double)
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<BasicActivatorFunc<TestType>> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<BasicSigmoidFunc<TestType>>();
+    else
+        activator = std::make_shared<BasicModReluFunc<TestType>>();
+
+    const auto layers = random_layers<TestType>({784, 100, 10});
+    const std::string filename = "neuronet_test_weights.txt";
+    write_weights(filename, layers);
+
+    BasicNeuroNet<TestType> net(layers.sizes, activator);
+    net.read_weights(filename);
+    std::remove(filename.c_str());
+
+    for (int sample = 0; sample < 20; sample++)
+    {
+        const auto input = random_input<TestType>(784);
+        REQUIRE(net.analyze(input) == reference_analyze(layers, *activator, input));
+    }
+}
+
+TEST_CASE("NeuroNet::analyze throws on mismatching input size")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({16, 8, 4}, activator);
+
+    REQUIRE_THROWS_AS(net.analyze(std::vector<float>(15)), std::exception);
+}
+
+TEST_CASE("NeuroNet training steps do no Matrix allocations once warmed up")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 64, 32, 10}, activator);
+
+    std::vector<std::vector<float>> inputs;
+    for (int sample = 0; sample < 8; sample++)
+    {
+        inputs.push_back(random_input(784));
+    }
+
+    net.analyze(inputs[0]);
+    net.back_propagate(3, 0.1);
+
+    const auto allocations = Matrix::allocation_count();
+    for (int step = 0; step < 50; step++)
+    {
+        net.analyze(inputs[step % inputs.size()]);
+        net.back_propagate(step % 10, 0.1);
+        net.check_for_nan();
+    }
+
+    REQUIRE(Matrix::allocation_count() == allocations);
+}
+
+TEST_CASE("NeuroNet::train_batch applies the sum of the per-sample back_propagate steps")
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<BasicActivatorFunc<double>> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<BasicSigmoidFunc<double>>();
+    else
+        activator = std::make_shared<BasicModReluFunc<double>>();
+
+    const unsigned int batch = GENERATE(as<unsigned int>{}, 1, 7, 32);
+    const auto layers = random_layers<double>({784, 40, 24, 10});
+    const std::string filename = "neuronet_batch_test_weights.txt";
+    write_weights(filename, layers);
+
+    BasicNeuroNet<double> net(layers.sizes, activator);
+    net.read_weights(filename);
+    std::remove(filename.c_str());
+
+    std::vector<int> labels;
+    std::vector<std::vector<double>> inputs;
+    for (unsigned int sample = 0; sample < batch; sample++)
+    {
+        labels.push_back(sample % 10);
+        inputs.push_back(random_input<double>(784));
+    }
+
+    // Every sample steps a copy of the untouched network, the deltas add up.
+    auto expected_weights = net.weights();
+    auto expected_bioses = net.bioses();
+    int expected_good = 0;
+    for (unsigned int sample = 0; sample < batch; sample++)
+    {
+        auto single = net;
+        expected_good += single.analyze(inputs[sample]) == labels[sample];
+        single.back_propagate(labels[sample], 0.1);
+        for (unsigned int layer = 0; layer < expected_weights.size(); layer++)
+        {
+            expected_weights[layer] += single.weights()[layer] - net.weights()[layer];
+            expected_bioses[layer] += single.bioses()[layer] - net.bioses()[layer];
+        }
+    }
+
+    REQUIRE(net.train_batch(labels, inputs, 0.1) == expected_good);
+
+    for (unsigned int layer = 0; layer < expected_weights.size(); layer++)
+    {
+        const auto size = expected_weights[layer].size();
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            for (unsigned int j = 0; j < size.second; j++)
+            {
+                REQUIRE(std::abs(net.weights()[layer](i, j) - expected_weights[layer](i, j)) < 1e-9);
+            }
+            REQUIRE(std::abs(net.bioses()[layer](i, 0) - expected_bioses[layer](i, 0)) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE("NeuroNet::train_batch reuses its workspaces for the same batch size")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 64, 10}, activator);
+
+    std::vector<int> labels;
+    std::vector<std::vector<float>> inputs;
+    for (int sample = 0; sample < 16; sample++)
+    {
+        labels.push_back(sample % 10);
+        inputs.push_back(random_input(784));
+    }
+
+    net.train_batch(labels, inputs, 0.1);
+
+    const auto allocations = Matrix::allocation_count();
+    for (int step = 0; step < 10; step++)
+    {
+        net.train_batch(labels, inputs, 0.1);
+        net.check_for_nan();
+    }
+
+    REQUIRE(Matrix::allocation_count() == allocations);
+    REQUIRE_THROWS_AS(net.train_batch(std::vector<int>(3), inputs, 0.1), std::exception);
+}
+
+TEST_CASE("NeuroNet::train_batch reshapes its workspace for a short last batch")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto layers = random_layers<float>({784, 64, 10});
+    const std::string filename = "neuronet_tail_test_weights.txt";
+    write_weights(filename, layers);
+
+    NeuroNet net(layers.sizes, activator);
+    NeuroNet fresh(layers.sizes, activator);
+    net.read_weights(filename);
+    fresh.read_weights(filename);
+    std::remove(filename.c_str());
+
+    std::vector<int> labels;
+    std::vector<std::vector<float>> inputs;
+    for (int sample = 0; sample < 16; sample++)
+    {
+        labels.push_back(sample % 10);
+        inputs.push_back(random_input(784));
+    }
+    const std::vector<int> tail_labels(labels.begin(), labels.begin() + 5);
+    const std::vector<std::vector<float>> tail_inputs(inputs.begin(), inputs.begin() + 5);
+
+    // A zero study_coef leaves the weights as they were read.
+    net.train_batch(labels, inputs, 0);
+    net.train_batch(tail_labels, tail_inputs, 0);
+    const auto allocations = Matrix::allocation_count();
+    for (int step = 0; step < 5; step++)
+    {
+        net.train_batch(labels, inputs, 0);
+        net.train_batch(tail_labels, tail_inputs, 0);
+    }
+    REQUIRE(Matrix::allocation_count() == allocations);
+
+    // The reshaped workspace steps like one built for the short batch.
+    net.train_batch(labels, inputs, 0);
+    REQUIRE(net.train_batch(tail_labels, tail_inputs, 0.1) == fresh.train_batch(tail_labels, tail_inputs, 0.1));
+    for (unsigned int layer = 0; layer < net.weights().size(); layer++)
+    {
+        const auto size = net.weights()[layer].size();
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            for (unsigned int j = 0; j < size.second; j++)
+            {
+                REQUIRE(net.weights()[layer](i, j) == fresh.weights()[layer](i, j));
+            }
+            REQUIRE(net.bioses()[layer](i, 0) == fresh.bioses()[layer](i, 0));
+        }
+    }
+}
+
+TEST_CASE("NeuroNet::analyze_batch gives the answers and outputs of analyze")
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<BasicActivatorFunc<double>> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<BasicSigmoidFunc<double>>();
+    else
+        activator = std::make_shared<BasicModReluFunc<double>>();
+
+    // GEMV sized, GEMM sized, at and across the tile size, with short last tiles.
+    const unsigned int count = GENERATE(as<unsigned int>{}, 1, 7, 12, 64, 150);
+    const auto layers = random_layers<double>({784, 40, 24, 10});
+    const std::string filename = "neuronet_analyze_batch_test_weights.txt";
+    write_weights(filename, layers);
+
+    BasicNeuroNet<double> net(layers.sizes, activator);
+    net.read_weights(filename);
+    std::remove(filename.c_str());
+
+    std::vector<std::vector<double>> inputs;
+    for (unsigned int sample = 0; sample < count; sample++)
+    {
+        inputs.push_back(random_input<double>(784));
+    }
+
+    BasicMatrix<double> scores(0, 0);
+    const auto answers = net.analyze_batch(inputs, &scores);
+    REQUIRE(answers.size() == count);
+    REQUIRE(scores.size() == std::make_pair(count, 10u));
+
+    BasicNeuroNet<double>::SampleWorkspace workspace;
+    for (unsigned int sample = 0; sample < count; sample++)
+    {
+        REQUIRE(answers[sample] == net.analyze(inputs[sample], workspace));
+        for (unsigned int i = 0; i < 10; i++)
+        {
+            REQUIRE(std::abs(scores(sample, i) - workspace.neurons.back()(i, 0)) < 1e-12);
+        }
+    }
+
+    // Warmed up, a second run allocates no Matrix and agrees with the first.
+    const auto allocations = BasicMatrix<double>::allocation_count();
+    REQUIRE(net.analyze_batch(inputs, &scores) == answers);
+    REQUIRE(BasicMatrix<double>::allocation_count() == allocations);
+
+    // Fewer samples fill the first rows of the scores they already have.
+    const std::vector<std::vector<double>> first(inputs.begin(), inputs.begin() + count / 2);
+    const double* storage = scores.data();
+    const auto first_answers = net.analyze_batch(first, &scores);
+    REQUIRE(scores.data() == storage);
+    REQUIRE(scores.size() == std::make_pair(count, 10u));
+    REQUIRE(std::equal(first_answers.begin(), first_answers.end(), answers.begin()));
+}
+
+TEST_CASE("Threads share one const NeuroNet through their own workspaces")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet model({784, 64, 10}, activator);
+    const NeuroNet& net = model;
+
+    std::vector<std::vector<float>> inputs;
+    for (int sample = 0; sample < 100; sample++)
+    {
+        inputs.push_back(random_input(784));
+    }
+    const auto expected = model.analyze_batch(inputs);
+
+    constexpr unsigned int threads = 4;
+    std::vector<std::vector<int>> answers(threads, std::vector<int>(inputs.size()));
+    std::vector<std::vector<int>> batch_answers(threads, std::vector<int>(inputs.size()));
+    WorkerPool pool(threads);
+    pool.run([&](unsigned int thread) {
+        NeuroNet::SampleWorkspace sample;
+        for (std::size_t i = 0; i < inputs.size(); i++)
+        {
+            answers[thread][i] = net.analyze(inputs[i], sample);
+        }
+
+        NeuroNet::AnalyzeWorkspace batch;
+        net.analyze_batch(inputs.data(), inputs.size(), batch_answers[thread].data(), nullptr, batch);
+    });
+
+    for (unsigned int thread = 0; thread < threads; thread++)
+    {
+        REQUIRE(answers[thread] == expected);
+        REQUIRE(batch_answers[thread] == expected);
+    }
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "ParallelTrainer.hpp"
+#include "WorkerPool.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    std::vector<double> random_input(unsigned int size)
+    {
+        std::vector<double> input(size);
+        for (auto& value : input)
+        {
+            value = static_cast<double>(rand()) / RAND_MAX;
+        }
+        return input;
+    }
+}
+
+TEST_CASE("WorkerPool runs every job once on every worker and rethrows failures")
+{
+    const unsigned int size = GENERATE(as<unsigned int>{}, 1, 3, 8);
+    WorkerPool pool(size);
+    REQUIRE(pool.size() == size);
+
+    std::vector<int> calls(size, 0);
+    for (int round = 0; round < 20; round++)
+    {
+        pool.run([&](unsigned int worker) { calls[worker]++; });
+    }
+    REQUIRE(calls == std::vector<int>(size, 20));
+
+    REQUIRE_THROWS_AS(pool.run([&](unsigned int worker) {
+        if (worker == pool.size() - 1)
+            throw std::runtime_error("worker failed");
+    }), std::runtime_error);
+
+    std::atomic<int> after_failure{0};
+    pool.run([&](unsigned int) { after_failure++; });
+    REQUIRE(after_failure == static_cast<int>(size));
+}
+
+TEST_CASE("ParallelTrainer takes the same step as NeuroNet::train_batch")
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<BasicActivatorFunc<double>> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<BasicSigmoidFunc<double>>();
+    else
+        activator = std::make_shared<BasicModReluFunc<double>>();
+
+    const unsigned int threads = GENERATE(as<unsigned int>{}, 1, 2, 5);
+    const unsigned int batch = GENERATE(as<unsigned int>{}, 3, 40);
+
+    BasicNeuroNet<double> net({784, 48, 16, 10}, activator);
+    auto reference = net;
+    BasicParallelTrainer<double> trainer(net, threads);
+    REQUIRE(trainer.threads() == threads);
+
+    for (int step = 0; step < 3; step++)
+    {
+        std::vector<int> labels;
+        std::vector<std::vector<double>> inputs;
+        for (unsigned int sample = 0; sample < batch; sample++)
+        {
+            labels.push_back(rand() % 10);
+            inputs.push_back(random_input(784));
+        }
+
+        REQUIRE(trainer.train_batch(labels, inputs, 0.1) == reference.train_batch(labels, inputs, 0.1));
+    }
+
+    for (unsigned int layer = 0; layer < net.weights().size(); layer++)
+    {
+        const auto size = net.weights()[layer].size();
+        for (unsigned int i = 0; i < size.first; i++)
+        {
+            for (unsigned int j = 0; j < size.second; j++)
+            {
+                REQUIRE(std::abs(net.weights()[layer](i, j) - reference.weights()[layer](i, j)) < 1e-9);
+            }
+            REQUIRE(std::abs(net.bioses()[layer](i, 0) - reference.bioses()[layer](i, 0)) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE("ParallelTrainer reports bad batches from any worker")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 32, 10}, activator);
+    ParallelTrainer trainer(net, 3);
+
+    std::vector<int> labels(6, 1);
+    std::vector<std::vector<float>> inputs(6, std::vector<float>(784));
+    inputs[5].resize(100);
+
+    REQUIRE_THROWS_AS(trainer.train_batch(labels, inputs, 0.1), std::exception);
+    REQUIRE_THROWS_AS(trainer.train_batch(std::vector<int>(2), inputs, 0.1), std::exception);
+}
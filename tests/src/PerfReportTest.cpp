@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "PerfReport.hpp"
+
+namespace
+{
+    std::vector<PerfResult> example_results()
+    {
+        PerfResult batch;
+        batch.name = "analyze_batch \"64\", a\\b";
+        batch.samples = 10;
+        batch.iterations = 100;
+        batch.mean_ns = 1000;
+        batch.low_mean_ns = 900;
+        batch.high_mean_ns = 1100;
+        batch.std_dev_ns = 50;
+        batch.items_per_call = 64;
+
+        PerfResult io = batch;
+        io.name = "read_weights";
+        io.items_per_call = 0;
+        return {batch, io};
+    }
+}
+
+TEST_CASE("perf::write_csv doubles quotes and leaves samples_per_sec empty without items")
+{
+    std::ostringstream output;
+    perf::write_csv(output, example_results());
+
+    REQUIRE(output.str() ==
+        "name,samples,iterations,ns_per_op,low_ns_per_op,high_ns_per_op,std_dev_ns,items_per_call,samples_per_sec\n"
+        "\"analyze_batch \"\"64\"\", a\\b\",10,100,1000,900,1100,50,64,6.4e+07\n"
+        "\"read_weights\",10,100,1000,900,1100,50,0,\n");
+}
+
+TEST_CASE("perf::write_json escapes names and writes null samples_per_sec without items")
+{
+    std::ostringstream output;
+    perf::write_json(output, example_results());
+
+    REQUIRE(output.str() ==
+        "{\n  \"benchmarks\": [\n"
+        "    {\"name\": \"analyze_batch \\\"64\\\", a\\\\b\", \"samples\": 10, \"iterations\": 100, \"ns_per_op\": 1000, \"low_ns_per_op\": 900, "
+        "\"high_ns_per_op\": 1100, \"std_dev_ns\": 50, \"items_per_call\": 64, \"samples_per_sec\": 6.4e+07},\n"
+        "    {\"name\": \"read_weights\", \"samples\": 10, \"iterations\": 100, \"ns_per_op\": 1000, \"low_ns_per_op\": 900, "
+        "\"high_ns_per_op\": 1100, \"std_dev_ns\": 50, \"items_per_call\": 0, \"samples_per_sec\": null}\n"
+        "  ]\n}\n");
+}
+
+TEST_CASE("perf::items registers the items per call of a benchmark name")
+{
+    REQUIRE(perf::items("perf_report_test benchmark", 256) == "perf_report_test benchmark");
+    REQUIRE(perf::items_of("perf_report_test benchmark") == 256);
+    REQUIRE(perf::items_of("perf_report_test unregistered") == 0);
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "QuantizedNeuroNet.hpp"
+#include "WorkerPool.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+#include "kernels/Int8.hpp"
+
+#include "TestHelpers.hpp"
+
+TEST_CASE("kernels::gemv_u8s8 matches the scalar product on every supported instruction set")
+{
+    const auto isa = GENERATE(kernels::Isa::Scalar, kernels::Isa::Avx2, kernels::Isa::Avx512);
+    if (not kernels::isa_supported(isa))
+        return;
+
+    IsaGuard guard;
+    kernels::set_isa(isa);
+
+    const unsigned int m = GENERATE(as<unsigned int>{}, 1, 10, 256);
+    const unsigned int n = GENERATE(as<unsigned int>{}, 1, 33, 784);
+    const std::size_t lda = n + 3;
+
+    std::vector<std::int8_t> a(m * lda);
+    std::vector<std::uint8_t> x(n);
+    for (auto& value : a)
+        value = static_cast<std::int8_t>(rand() % 255 - 127);
+    for (auto& value : x)
+        value = static_cast<std::uint8_t>(rand() % 128);
+
+    std::vector<std::int32_t> expected(m), y(m, -1);
+    kernels::scalar::gemv_u8s8(m, n, a.data(), lda, x.data(), expected.data());
+    kernels::gemv_u8s8(m, n, a.data(), lda, x.data(), y.data());
+
+    REQUIRE(y == expected);
+}
+
+TEST_CASE("QuantizedNeuroNet mostly agrees with the float network it was built from")
+{
+    const auto use_sigmoid = GENERATE(false, true);
+    std::shared_ptr<IActivatorFunc> activator;
+    if (use_sigmoid)
+        activator = std::make_shared<SigmoidFunc>();
+    else
+        activator = std::make_shared<ModReluFunc>();
+
+    const auto data = random_dataset(200);
+    NeuroNet net({SAMPLE_SIZE, 64, 10}, activator);
+    for (int epoch = 0; epoch < 3; epoch++)
+    {
+        for (const auto& sample : data)
+        {
+            net.analyze(sample.second);
+            net.back_propagate(sample.first, 0.1);
+        }
+    }
+
+    QuantizedNeuroNet quantized(activator);
+    quantized.quantize(net, Dataset(data.begin(), data.begin() + 50));
+    REQUIRE(quantized.layers_sizes() == net.layers_sizes());
+
+    int same = 0;
+    for (const auto& sample : data)
+    {
+        if (quantized.analyze(sample.second) == static_cast<int>(net.analyze(sample.second)))
+            same++;
+    }
+    REQUIRE(same >= 180);
+}
+
+TEST_CASE("QuantizedNeuroNet round trips through its binary file")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto data = random_dataset(20);
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+
+    QuantizedNeuroNet quantized(activator);
+    quantized.quantize(net, data);
+
+    const std::string filename = "quantized_neuronet_test.q8";
+    quantized.save(filename);
+    QuantizedNeuroNet loaded(activator);
+    loaded.load(filename);
+    std::remove(filename.c_str());
+
+    REQUIRE(loaded.layers_sizes() == quantized.layers_sizes());
+    REQUIRE(loaded.weights_bytes() == quantized.weights_bytes());
+    for (const auto& sample : data)
+    {
+        REQUIRE(loaded.analyze(sample.second) == quantized.analyze(sample.second));
+    }
+
+    REQUIRE_THROWS_AS(loaded.load("missing_quantized_weights.q8"), std::exception);
+}
+
+TEST_CASE("Threads share one const QuantizedNeuroNet through their own workspaces")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    const auto data = random_dataset(40);
+    NeuroNet net({SAMPLE_SIZE, 32, 10}, activator);
+
+    QuantizedNeuroNet model(activator);
+    model.quantize(net, data);
+    const QuantizedNeuroNet& quantized = model;
+
+    std::vector<int> expected;
+    for (const auto& sample : data)
+    {
+        expected.push_back(model.analyze(sample.second));
+    }
+
+    constexpr unsigned int threads = 4;
+    std::vector<std::vector<int>> answers(threads);
+    WorkerPool pool(threads);
+    pool.run([&](unsigned int thread) {
+        QuantizedNeuroNet::Workspace workspace;
+        for (const auto& sample : data)
+        {
+            answers[thread].push_back(quantized.analyze(sample.second, workspace));
+        }
+    });
+
+    for (const auto& thread_answers : answers)
+    {
+        REQUIRE(thread_answers == expected);
+    }
+}
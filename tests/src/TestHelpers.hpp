@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Dataset.hpp"
+#include "IdxDataset.hpp"
+#include "kernels/CpuFeatures.hpp"
+
+// Restores the dispatch target when a test case is done with it.
+struct IsaGuard
+{
+    kernels::Isa saved = kernels::active_isa();
+    ~IsaGuard() { kernels::set_isa(saved); }
+};
+
+// Uniform pixels in [0, 1], labels go round 0..9.
+inline Dataset random_dataset(std::size_t count)
+{
+    Dataset result;
+    for (std::size_t sample = 0; sample < count; sample++)
+    {
+        std::vector<float> input(SAMPLE_SIZE);
+        for (auto& value : input)
+        {
+            value = static_cast<float>(rand()) / RAND_MAX;
+        }
+        result.emplace_back(static_cast<int>(sample % 10), std::move(input));
+    }
+    return result;
+}
+
+// An IDX file of unsigned bytes with the given dimensions, the first is the count.
+inline void write_idx(const std::string& filename, const std::vector<std::uint32_t>& dimensions, const std::vector<std::uint8_t>& data)
+{
+    std::ofstream output(filename, std::ios::binary);
+    const char magic[4] = {0, 0, char(IdxDataset::UNSIGNED_BYTE), char(dimensions.size())};
+    output.write(magic, sizeof(magic));
+    for (const auto size : dimensions)
+    {
+        const char bytes[4] = {char(size >> 24), char(size >> 16), char(size >> 8), char(size)};
+        output.write(bytes, sizeof(bytes));
+    }
+    output.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Dataset.hpp"
+#include "TextParser.hpp"
+
+namespace
+{
+    // Values in every notation the text files have seen, big enough to be split
+    // into several pieces.
+    std::string numbers_text(std::size_t count)
+    {
+        std::ostringstream output;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const double value = (static_cast<double>(rand()) / RAND_MAX - 0.5) * std::pow(10.0, rand() % 12 - 6);
+            switch (i % 4)
+            {
+                case 0: output << value; break;
+                case 1: output << std::setprecision(17) << value << std::setprecision(6); break;
+                case 2: output << std::scientific << value << std::defaultfloat; break;
+                default: output << static_cast<int>(value * 1000); break;
+            }
+            output << (i % 7 == 0 ? "\n" : (i % 5 == 0 ? "\t " : " "));
+        }
+        return output.str();
+    }
+
+    template<typename T>
+    std::vector<T> stream_numbers(const std::string& text)
+    {
+        std::istringstream input(text);
+        std::vector<T> result;
+        T value;
+        while (input >> value)
+        {
+            result.push_back(value);
+        }
+        return result;
+    }
+}
+
+TEMPLATE_TEST_CASE("parse_numbers gives the same bits as operator>>", "", float, double)
+{
+    const auto text = numbers_text(200000);
+    const auto expected = stream_numbers<TestType>(text);
+
+    for (unsigned int threads : {1u, 3u, 8u})
+    {
+        const auto values = parse_numbers<TestType>(text.data(), text.data() + text.size(), threads);
+        REQUIRE(values.size() == expected.size());
+        REQUIRE(std::memcmp(values.data(), expected.data(), values.size() * sizeof(TestType)) == 0);
+    }
+}
+
+TEST_CASE("parse_numbers handles signs, limits and bad input")
+{
+    const std::string text = "  +1.5 -2 3e2\n\n0.25  ";
+    REQUIRE(parse_numbers<float>(text.data(), text.data() + text.size()) == std::vector<float>{1.5f, -2, 300, 0.25f});
+    REQUIRE(parse_numbers<float>(text.data(), text.data() + text.size(), 1, 2) == std::vector<float>{1.5f, -2});
+
+    const std::string empty = " \n ";
+    REQUIRE(parse_numbers<float>(empty.data(), empty.data() + empty.size()).empty());
+
+    const std::string bad = "1 2 x3 4";
+    REQUIRE_THROWS_AS(parse_numbers<float>(bad.data(), bad.data() + bad.size()), std::exception);
+    const std::string glued = "1 2.5.5";
+    REQUIRE_THROWS_AS(parse_numbers<float>(glued.data(), glued.data() + glued.size()), std::exception);
+}
+
+TEST_CASE("read_text_dataset reads every sample once, trailing whitespace included")
+{
+    const std::string filename = "text_parser_dataset.txt";
+    {
+        std::ofstream output(filename);
+        output.precision(9);
+        for (int sample = 0; sample < 3; sample++)
+        {
+            output << sample;
+            for (unsigned int i = 0; i < SAMPLE_SIZE; i++)
+            {
+                output << " " << (sample * SAMPLE_SIZE + i) % 255 / 255.0f;
+            }
+            output << "\n";
+        }
+        output << "\n  \n";
+    }
+
+    const auto data = read_text_dataset(filename);
+    REQUIRE(data.size() == 3);
+    REQUIRE(data[2].first == 2);
+    REQUIRE(data[2].second[5] == (2 * SAMPLE_SIZE + 5) % 255 / 255.0f);
+    REQUIRE(read_text_dataset(filename, 2).size() == 2);
+
+    {
+        std::ofstream output(filename, std::ios::app);
+        output << "7 0.5 0.5";
+    }
+    REQUIRE_THROWS_AS(read_text_dataset(filename), std::exception);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,190 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NeuroNet.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+namespace
+{
+    template<typename T>
+    void require_same_matrix(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs)
+    {
+        REQUIRE(lhs.size() == rhs.size());
+        for (unsigned int i = 0; i < lhs.size().first; i++)
+        {
+            REQUIRE(std::memcmp(lhs.row(i), rhs.row(i), lhs.size().second * sizeof(T)) == 0);
+        }
+    }
+
+    // Changes entry i of the section table and recomputes the checksum, so only the
+    // section checks stand between the file and the loader.
+    template<typename Change>
+    void rewrite_section(const std::string& filename, unsigned int layers, unsigned int i, Change change)
+    {
+        std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+        std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        WeightsSection section;
+        const std::size_t section_offset = WeightsFile::sections_offset(layers) + i * sizeof(section);
+        std::memcpy(&section, contents.data() + section_offset, sizeof(section));
+        change(section);
+        std::memcpy(contents.data() + section_offset, &section, sizeof(section));
+
+        WeightsFileHeader header;
+        std::memcpy(&header, contents.data(), sizeof(header));
+        header.checksum = weights_checksum(reinterpret_cast<const std::uint8_t*>(contents.data()) + sizeof(header), contents.size() - sizeof(header));
+        std::memcpy(contents.data(), &header, sizeof(header));
+
+        file.seekp(0);
+        file.write(contents.data(), contents.size());
+    }
+
+    template<typename T>
+    void require_same_weights(const BasicNeuroNet<T>& lhs, const BasicNeuroNet<T>& rhs)
+    {
+        REQUIRE(lhs.layers_sizes() == rhs.layers_sizes());
+        for (unsigned int layer = 0; layer < lhs.weights().size(); layer++)
+        {
+            require_same_matrix(lhs.weights()[layer], rhs.weights()[layer]);
+            require_same_matrix(lhs.bioses()[layer], rhs.bioses()[layer]);
+        }
+    }
+}
+
+TEST_CASE("Binary weights read back bit for bit and view the mapped file")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({784, 40, 10}, activator);
+    net.train_batch(std::vector<int>{3, 7}, std::vector<std::vector<float>>(2, std::vector<float>(784, 0.3f)), 0.1);
+
+    const std::string filename = "weights_file_test.bin";
+    net.save_weights_binary(filename);
+    REQUIRE(is_weights_file(filename));
+
+    NeuroNet loaded({1, 1}, activator);
+    loaded.read_weights(filename);
+    require_same_weights(net, loaded);
+    for (unsigned int layer = 0; layer < loaded.weights().size(); layer++)
+    {
+        REQUIRE_FALSE(loaded.weights()[layer].owns_data());
+        REQUIRE_FALSE(loaded.bioses()[layer].owns_data());
+    }
+
+    // Training a mapped network changes private copies of the pages, not the file.
+    const std::vector<float> input(784, 0.5f);
+    const auto before = loaded.weights()[1](0, 0);
+    loaded.analyze(input);
+    loaded.back_propagate(1, 1.0);
+    REQUIRE(loaded.weights()[1](0, 0) != before);
+
+    NeuroNet reloaded({1, 1}, activator);
+    reloaded.read_weights(filename);
+    require_same_weights(net, reloaded);
+
+    // Saving over the file a network still maps leaves that network intact.
+    const auto trained = loaded.weights()[1](0, 0);
+    loaded.save_weights_binary(filename);
+    REQUIRE(loaded.weights()[1](0, 0) == trained);
+    REQUIRE(loaded.analyze(input) == loaded.analyze(input));
+
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Binary weights of another precision are converted")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    auto double_activator = std::make_shared<BasicSigmoidFunc<double>>();
+    BasicNeuroNet<double> net({20, 8, 4}, double_activator);
+
+    const std::string filename = "weights_file_double.bin";
+    net.save_weights_binary(filename);
+
+    NeuroNet loaded({1, 1}, activator);
+    loaded.read_weights(filename);
+    REQUIRE(loaded.layers_sizes() == net.layers_sizes());
+    REQUIRE(loaded.weights()[0].owns_data());
+    REQUIRE(loaded.weights()[0](7, 19) == static_cast<float>(net.weights()[0](7, 19)));
+
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Text weights read back bit for bit")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({30, 12, 10}, activator);
+    net.train_batch(std::vector<int>{1}, std::vector<std::vector<float>>(1, std::vector<float>(30, 0.7f)), 0.37);
+
+    const std::string filename = "weights_file_test.txt";
+    net.save_weights(filename);
+
+    NeuroNet loaded({1, 1}, activator);
+    loaded.read_weights(filename);
+    require_same_weights(net, loaded);
+
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Binary weights with a wrong checksum are rejected")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({16, 8, 4}, activator);
+
+    const std::string filename = "weights_file_corrupt.bin";
+    net.save_weights_binary(filename);
+    {
+        std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-5, std::ios::end);
+        file.put('\x7f');
+    }
+
+    NeuroNet loaded({1, 1}, activator);
+    REQUIRE_THROWS_AS(loaded.read_weights(filename), std::exception);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Binary weights with a section past the end are rejected despite a right checksum")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({16, 8, 4}, activator);
+
+    const std::string filename = "weights_file_crafted.bin";
+    net.save_weights_binary(filename);
+    // offset + rows * stride * 4 of the first section wraps around to a few hundred bytes.
+    rewrite_section(filename, 3, 0, [](WeightsSection& section) {
+        section.offset = ~std::uint64_t(0) - WEIGHTS_FILE_ALIGNMENT + 1;
+    });
+
+    REQUIRE_THROWS_AS(WeightsFile(filename), std::runtime_error);
+    NeuroNet loaded({1, 1}, activator);
+    REQUIRE_THROWS_AS(loaded.read_weights(filename), std::exception);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Binary weights with another stride than Matrix's are rejected")
+{
+    auto activator = std::make_shared<SigmoidFunc>();
+    NeuroNet net({20, 8, 4}, activator);
+
+    // Section 0 holds 8 rows of 20 weights padded to 32, section 1 the 8 bioses.
+    const auto change = GENERATE(std::make_pair(0u, 24u), std::make_pair(0u, 20u), std::make_pair(1u, 2u));
+    const std::string filename = "weights_file_stride.bin";
+    net.save_weights_binary(filename);
+    rewrite_section(filename, 3, change.first, [&](WeightsSection& section) {
+        section.stride = change.second;
+    });
+
+    REQUIRE_THROWS_AS(WeightsFile(filename), std::runtime_error);
+    NeuroNet loaded({1, 1}, activator);
+    REQUIRE_THROWS_AS(loaded.read_weights(filename), std::exception);
+    std::remove(filename.c_str());
+}
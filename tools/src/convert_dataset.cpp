@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "BinaryDataset.hpp"
+#include "Dataset.hpp"
+
+// Converts a lib_10k.txt style text dataset into the memory-mapped binary format.
+//
+// usage: neuron_digits-convert-dataset <dataset.txt> <dataset.bin> [uint8|float32]
+//
+// uint8 is 4x smaller and exact for MNIST derived data, whose pixels are k / 255;
+// the largest rounding error is reported so other data can be checked.
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <dataset.txt> <dataset.bin> [uint8|float32]" << std::endl;
+        return 1;
+    }
+
+    const std::string input_file = argv[1];
+    const std::string output_file = argv[2];
+    const std::string type_name = argc > 3 ? argv[3] : "uint8";
+
+    PixelType type;
+    if (type_name == "uint8")
+        type = PixelType::UInt8;
+    else if (type_name == "float32")
+        type = PixelType::Float32;
+    else
+    {
+        std::cerr << "Unknown pixel type \"" << type_name << "\"." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        auto start_point = std::chrono::steady_clock::now();
+        const auto data = read_text_dataset(input_file);
+        const std::chrono::duration<double> parse_time = std::chrono::steady_clock::now() - start_point;
+
+        const float max_error = write_binary_dataset(output_file, data, type);
+
+        start_point = std::chrono::steady_clock::now();
+        const BinaryDataset mapped(output_file);
+        const std::chrono::duration<double> open_time = std::chrono::steady_clock::now() - start_point;
+
+        std::cout << "Converted " << mapped.size() << " samples of " << mapped.sample_size() << " " << type_name << " pixels into \"" << output_file << "\"." << std::endl;
+        std::cout << "Text parse: " << parse_time.count() * 1e3 << "ms; binary open: " << open_time.count() * 1e3 << "ms";
+        if (type == PixelType::UInt8)
+            std::cout << "; max pixel error: " << max_error;
+        std::cout << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NeuroNet.hpp"
+#include "WeightsFile.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+// Converts weights between the text format of weights.txt and the binary format
+// of WeightsFile.hpp, the direction following the input's format.
+//
+// usage: neuron_digits-convert-weights <input> <output>
+//
+// Both formats keep every float bit for bit. The times to the first prediction
+// from either file are reported.
+
+namespace
+{
+    // Loads filename into a fresh network and runs one prediction.
+    double seconds_to_first_prediction(const std::string& filename, std::shared_ptr<IActivatorFunc> activator)
+    {
+        const auto start_point = std::chrono::steady_clock::now();
+        NeuroNet net({1, 1}, activator);
+        net.read_weights(filename);
+        net.analyze(std::vector<float>(net.layers_sizes().front()));
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start_point;
+        return spent.count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <input> <output>" << std::endl;
+        return 1;
+    }
+
+    const std::string input_file = argv[1];
+    const std::string output_file = argv[2];
+
+    try
+    {
+        auto activator = std::make_shared<SigmoidFunc>();
+        NeuroNet net({1, 1}, activator);
+        net.read_weights(input_file);
+
+        const bool to_binary = not is_weights_file(input_file);
+        if (to_binary)
+            net.save_weights_binary(output_file);
+        else
+            net.save_weights(output_file);
+
+        const auto& text_file = to_binary ? input_file : output_file;
+        const auto& binary_file = to_binary ? output_file : input_file;
+        const double text_seconds = seconds_to_first_prediction(text_file, activator);
+        const double binary_seconds = seconds_to_first_prediction(binary_file, activator);
+        std::cout << "Converted \"" << input_file << "\" into " << (to_binary ? "binary" : "text") << " \"" << output_file << "\"." << std::endl;
+        std::cout << "First prediction from text: " << text_seconds * 1e3 << "ms; from binary: " << binary_seconds * 1e3 << "ms" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InferenceServer.hpp"
+#include "LatencyHistogram.hpp"
+
+// Load generator for neuron_digits-serve. Every client is a connection sending
+// requests of random pixels back to back, so the clients count is the number of
+// requests in flight. Reports the latencies the clients saw and the server's counters.
+//
+// usage: neuron_digits-loadgen [unix:<path>|tcp:<host>:<port>] [clients] [requests per client] [pixels]
+
+int main(int argc, char** argv)
+{
+    const std::string endpoint_text = argc > 1 ? argv[1] : "unix:/tmp/neuron_digits.sock";
+    const unsigned int clients = argc > 2 ? std::stoul(argv[2]) : 8;
+    const unsigned int requests = argc > 3 ? std::stoul(argv[3]) : 1000;
+    const std::uint32_t pixels_count = argc > 4 ? std::stoul(argv[4]) : 784;
+
+    try
+    {
+        const auto endpoint = Endpoint::parse(endpoint_text);
+        LatencyHistogram latency;
+        std::vector<std::exception_ptr> errors(clients);
+        std::vector<unsigned int> rejected(clients, 0);
+
+        const auto start_point = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned int client = 0; client < clients; client++)
+        {
+            threads.emplace_back([&, client]() {
+                try
+                {
+                    InferenceClient connection(endpoint);
+                    std::mt19937 random(client);
+                    std::vector<std::uint8_t> pixels(pixels_count);
+                    for (unsigned int request = 0; request < requests; request++)
+                    {
+                        for (auto& pixel : pixels)
+                        {
+                            pixel = static_cast<std::uint8_t>(random());
+                        }
+
+                        const auto sent = std::chrono::steady_clock::now();
+                        rejected[client] += connection.classify(pixels.data(), pixels_count) < 0;
+                        latency.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - sent).count());
+                    }
+                }
+                catch (...)
+                {
+                    errors[client] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start_point;
+
+        for (const auto& error : errors)
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        unsigned int total_rejected = 0;
+        for (const auto count : rejected)
+        {
+            total_rejected += count;
+        }
+
+        std::cout << "Clients: " << latency.count() << " requests from " << clients << " connections in " << spent.count() << "s, "
+                  << latency.count() / spent.count() << " requests/s, p50 " << latency.percentile(0.5) * 1e6
+                  << "us, p99 " << latency.percentile(0.99) * 1e6 << "us";
+        if (total_rejected)
+            std::cout << ", " << total_rejected << " rejected";
+        std::cout << std::endl;
+
+        const auto stats = InferenceClient(endpoint).stats();
+        std::cout << "Server: " << stats.requests << " requests in " << stats.batches << " batches (mean " << stats.mean_batch << "), "
+                  << "p50 " << stats.p50_seconds * 1e6 << "us, p99 " << stats.p99_seconds * 1e6 << "us" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
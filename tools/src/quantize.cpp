@@ -0,0 +1,124 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "Dataset.hpp"
+#include "NeuroNet.hpp"
+#include "QuantizedNeuroNet.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+// Quantizes trained weights to int8 and reports how much accuracy that costs
+// compared with the double precision model.
+//
+// usage: neuron_digits-quantize <weights.txt> <dataset.txt> <output.q8> [calibration samples] [sigmoid|modrelu]
+
+namespace
+{
+    struct Score
+    {
+        double accuracy;
+        double samples_per_second;
+    };
+
+    template<typename Net>
+    Score evaluate(Net& net, const Dataset& data, std::size_t first)
+    {
+        std::size_t good = 0;
+        const auto start_point = std::chrono::steady_clock::now();
+        for (std::size_t i = first; i < data.size(); i++)
+        {
+            if (static_cast<int>(net.analyze(data[i].second)) == data[i].first)
+                good++;
+        }
+        const std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start_point;
+
+        const auto total = data.size() - first;
+        return {good / static_cast<double>(total), total / spent.count()};
+    }
+
+    void print_usage(const char* program)
+    {
+        std::cerr << "usage: " << program << " <weights.txt> <dataset.txt> <output.q8> [calibration samples] [sigmoid|modrelu]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string weights_file = argv[1];
+    const std::string dataset_file = argv[2];
+    const std::string output_file = argv[3];
+    std::size_t calibration_count = 1000;
+    try
+    {
+        calibration_count = argc > 4 ? std::stoul(argv[4]) : calibration_count;
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << "Calibration samples must be a number, not \"" << argv[4] << "\"." << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+    const std::string activator_name = argc > 5 ? argv[5] : "sigmoid";
+
+    std::shared_ptr<IActivatorFunc> activator;
+    std::shared_ptr<BasicActivatorFunc<double>> reference_activator;
+    if (activator_name == "sigmoid")
+    {
+        activator = std::make_shared<SigmoidFunc>();
+        reference_activator = std::make_shared<BasicSigmoidFunc<double>>();
+    }
+    else if (activator_name == "modrelu")
+    {
+        activator = std::make_shared<ModReluFunc>();
+        reference_activator = std::make_shared<BasicModReluFunc<double>>();
+    }
+    else
+    {
+        std::cerr << "Unknown activator func \"" << activator_name << "\"." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        const auto data = read_text_dataset(dataset_file);
+        if (data.empty())
+            throw std::runtime_error("Dataset \"" + dataset_file + "\" is empty.");
+
+        // Calibrate on the head of the dataset and score on the rest, unless there is no rest.
+        const Dataset calibration(data.begin(), data.begin() + std::min(calibration_count, data.size()));
+        const std::size_t first_eval = calibration.size() < data.size() ? calibration.size() : 0;
+
+        NeuroNet net({SAMPLE_SIZE, 1, 10}, activator);
+        net.read_weights(weights_file);
+        BasicNeuroNet<double> reference(net.layers_sizes(), reference_activator);
+        reference.read_weights(weights_file);
+
+        QuantizedNeuroNet quantized(activator);
+        quantized.quantize(net, calibration);
+        quantized.save(output_file);
+
+        const auto reference_score = evaluate(reference, data, first_eval);
+        const auto quantized_score = evaluate(quantized, data, first_eval);
+
+        std::cout << "Calibrated on " << calibration.size() << " samples, evaluated on " << data.size() - first_eval << " samples." << std::endl;
+        std::cout << "double: accuracy " << reference_score.accuracy << "; " << reference_score.samples_per_second << " samples/s" << std::endl;
+        std::cout << "int8:   accuracy " << quantized_score.accuracy << "; " << quantized_score.samples_per_second << " samples/s" << std::endl;
+        std::cout << "Accuracy delta: " << quantized_score.accuracy - reference_score.accuracy
+                  << "; weights " << quantized.weights_bytes() << " bytes; written to \"" << output_file << "\"." << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
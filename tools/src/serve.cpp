@@ -0,0 +1,114 @@
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "InferenceServer.hpp"
+#include "MicroBatcher.hpp"
+#include "NeuroNet.hpp"
+#include "activators/ModReluFunc.hpp"
+#include "activators/SigmoidFunc.hpp"
+
+// Serves a trained network on a local socket (see InferenceServer.hpp for the
+// protocol), batching concurrent requests. Prints the serving counters every few
+// seconds and once more on Ctrl+C.
+//
+// usage: neuron_digits-serve <weights> [unix:<path>|tcp:<host>:<port>] [max batch] [max delay us] [threads] [sigmoid|modrelu]
+
+namespace
+{
+    volatile std::sig_atomic_t stop_requested = 0;
+
+    void request_stop(int)
+    {
+        stop_requested = 1;
+    }
+
+    void print_stats(const ServingStats& stats)
+    {
+        std::cout << stats.requests << " requests in " << stats.batches << " batches (mean " << stats.mean_batch << "), "
+                  << "p50 " << stats.p50_seconds * 1e6 << "us, p99 " << stats.p99_seconds * 1e6 << "us, "
+                  << stats.requests_per_second << " requests/s over " << stats.uptime_seconds << "s" << std::endl;
+    }
+
+    void print_usage(const char* program)
+    {
+        std::cerr << "usage: " << program << " <weights> [unix:<path>|tcp:<host>:<port>] [max batch] [max delay us] [threads] [sigmoid|modrelu]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string weights_file = argv[1];
+    const std::string endpoint_text = argc > 2 ? argv[2] : "unix:/tmp/neuron_digits.sock";
+    BatchingOptions options;
+    try
+    {
+        options.max_batch = argc > 3 ? std::stoul(argv[3]) : options.max_batch;
+        options.max_delay = argc > 4 ? std::chrono::microseconds(std::stoul(argv[4])) : options.max_delay;
+        options.threads = argc > 5 ? std::stoul(argv[5]) : options.threads;
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << "Max batch, max delay and threads must be numbers." << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+    const std::string activator_name = argc > 6 ? argv[6] : "sigmoid";
+
+    std::shared_ptr<IActivatorFunc> activator;
+    if (activator_name == "sigmoid")
+        activator = std::make_shared<SigmoidFunc>();
+    else if (activator_name == "modrelu")
+        activator = std::make_shared<ModReluFunc>();
+    else
+    {
+        std::cerr << "Unknown activator func \"" << activator_name << "\"." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        NeuroNet net({1, 1}, activator);
+        net.read_weights(weights_file);
+
+        MicroBatcher batcher(net, options);
+        InferenceServer server(batcher, Endpoint::parse(endpoint_text));
+        std::cout << "Serving on " << server.endpoint().to_string() << ", batches of up to " << options.max_batch
+                  << " within " << options.max_delay.count() << "us on " << options.threads << " threads." << std::endl;
+
+        std::signal(SIGINT, request_stop);
+        std::signal(SIGTERM, request_stop);
+
+        std::thread accepting([&server]() { server.run(); });
+        auto last_report = std::chrono::steady_clock::now();
+        while (not stop_requested)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() - last_report >= std::chrono::seconds(5))
+            {
+                print_stats(batcher.stats());
+                last_report = std::chrono::steady_clock::now();
+            }
+        }
+
+        server.stop();
+        accepting.join();
+        print_stats(batcher.stats());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}